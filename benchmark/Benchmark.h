@@ -0,0 +1,217 @@
+//
+// Created by FFZero on 2025-03-22.
+//
+
+#ifndef FFZKIT_BENCHMARK_H
+#define FFZKIT_BENCHMARK_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Util/CMD.h"
+#include "Util/logger.h"
+
+// 每个benchmark程序只有一个编译单元，在此替换全局operator new以统计内存分配次数
+static std::atomic<uint64_t> s_bench_alloc_count(0);
+static std::atomic<uint64_t> s_bench_alloc_bytes(0);
+
+void *operator new(size_t size) {
+    s_bench_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    s_bench_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (auto ptr = malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    free(ptr);
+}
+
+namespace FFZKit {
+
+class BenchResult {
+public:
+    std::string name;
+    size_t threads = 1;
+    uint64_t iterations = 0;
+    double ns_per_op = 0;
+    double ops_per_sec = 0;
+    double allocs_per_op = 0;
+    double bytes_per_op = 0;
+    // 用例自定义的指标，例如延时百分位
+    std::vector<std::pair<std::string, double> > metrics;
+};
+
+/**
+ * 简单的基准测试框架
+ * 每个用例执行指定次数的操作，统计耗时、吞吐和内存分配，结果可保存为json供bench_compare对比
+ */
+class Benchmark {
+public:
+    // 执行iterations次操作，函数返回时所有操作必须已经完成
+    using Runner = std::function<void(uint64_t iterations)>;
+
+    explicit Benchmark(std::string suite) : _suite(std::move(suite)) {}
+
+    /**
+     * 添加用例
+     * @param name 用例名
+     * @param iterations 默认迭代次数
+     * @param runner 用例执行函数
+     * @param threads 用例使用的线程数，仅用于输出
+     */
+    void add(const std::string &name, uint64_t iterations, Runner runner, size_t threads = 1) {
+        _cases.emplace_back(Case { name, iterations, threads, std::move(runner) });
+    }
+
+    /**
+     * 运行用例
+     * @param filter 只运行名字包含该字符串的用例，为空时全部运行
+     * @param scale 迭代次数缩放倍数
+     */
+    void run(const std::string &filter = "", double scale = 1.0) {
+        for (auto &item : _cases) {
+            if (!filter.empty() && item.name.find(filter) == std::string::npos) {
+                continue;
+            }
+            auto iterations = (uint64_t)(item.iterations * scale);
+            if (!iterations) {
+                iterations = 1;
+            }
+            // 预热
+            item.runner(iterations / 10 ? iterations / 10 : 1);
+
+            auto allocs = s_bench_alloc_count.load();
+            auto bytes = s_bench_alloc_bytes.load();
+            auto start = std::chrono::steady_clock::now();
+            item.runner(iterations);
+            auto ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+            BenchResult result;
+            result.name = item.name;
+            result.threads = item.threads;
+            result.iterations = iterations;
+            result.ns_per_op = ns / iterations;
+            result.ops_per_sec = ns > 0 ? iterations * 1e9 / ns : 0;
+            result.allocs_per_op = (double)(s_bench_alloc_count.load() - allocs) / iterations;
+            result.bytes_per_op = (double)(s_bench_alloc_bytes.load() - bytes) / iterations;
+            addResult(std::move(result));
+        }
+    }
+
+    /**
+     * 添加自行统计的结果，例如延时类测试
+     */
+    void addResult(BenchResult result) {
+        InfoL << std::left << std::setw(36) << result.name << " threads:" << result.threads
+              << " ns/op:" << result.ns_per_op << " ops/s:" << (uint64_t)result.ops_per_sec
+              << " allocs/op:" << result.allocs_per_op << " bytes/op:" << result.bytes_per_op;
+        for (auto &pr : result.metrics) {
+            InfoL << "    " << pr.first << ": " << pr.second;
+        }
+        _results.emplace_back(std::move(result));
+    }
+
+    const std::vector<BenchResult> &results() const {
+        return _results;
+    }
+
+    /**
+     * 保存结果为json文件
+     */
+    bool save(const std::string &path) const {
+        std::ofstream out(path, std::ios::out | std::ios::trunc);
+        if (!out) {
+            WarnL << "open " << path << " failed";
+            return false;
+        }
+        out << "{\n  \"suite\": \"" << escape(_suite) << "\",\n"
+            << "  \"timestamp\": " << time(nullptr) << ",\n"
+            << "  \"results\": [";
+        for (size_t i = 0; i < _results.size(); ++i) {
+            auto &result = _results[i];
+            out << (i ? ",\n" : "\n") << "    {\"name\": \"" << escape(result.name) << "\""
+                << ", \"threads\": " << result.threads
+                << ", \"iterations\": " << result.iterations
+                << ", \"ns_per_op\": " << result.ns_per_op
+                << ", \"ops_per_sec\": " << result.ops_per_sec
+                << ", \"allocs_per_op\": " << result.allocs_per_op
+                << ", \"bytes_per_op\": " << result.bytes_per_op;
+            for (auto &pr : result.metrics) {
+                out << ", \"" << escape(pr.first) << "\": " << pr.second;
+            }
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+        InfoL << "benchmark result saved to " << path;
+        return true;
+    }
+
+private:
+    static std::string escape(const std::string &str) {
+        std::string ret;
+        for (auto ch : str) {
+            if (ch == '"' || ch == '\\') {
+                ret.push_back('\\');
+            }
+            ret.push_back(ch);
+        }
+        return ret;
+    }
+
+private:
+    class Case {
+    public:
+        std::string name;
+        uint64_t iterations;
+        size_t threads;
+        Runner runner;
+    };
+
+    std::string _suite;
+    std::vector<Case> _cases;
+    std::vector<BenchResult> _results;
+};
+
+/**
+ * benchmark程序的通用命令行参数
+ */
+class CMD_benchmark : public CMD {
+public:
+    CMD_benchmark(const std::string &default_out) {
+        _parser = std::make_shared<OptionParser>(nullptr);
+        (*_parser) << Option('f', "filter", Option::ArgRequired, "", false, "only run cases whose name contains this string", nullptr);
+        (*_parser) << Option('s', "scale", Option::ArgRequired, "1", false, "scale factor of iterations", nullptr);
+        (*_parser) << Option('t', "threads", Option::ArgRequired, std::to_string(std::thread::hardware_concurrency()).data(), false, "thread count of multi-thread cases", nullptr);
+        (*_parser) << Option('o', "out", Option::ArgRequired, default_out.data(), false, "json result file", nullptr);
+    }
+
+    const char *description() const override {
+        return "benchmark options";
+    }
+
+    /**
+     * 添加额外参数
+     */
+    CMD_benchmark &operator<<(Option &&option) {
+        (*_parser) << std::move(option);
+        return *this;
+    }
+};
+
+} // namespace FFZKit
+
+#endif //FFZKIT_BENCHMARK_H
@@ -0,0 +1,238 @@
+//
+// Created by FFZero on 2025-03-22.
+//
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//只需解析benchmark输出的json，实现一个最小的json解析器
+class JsonValue {
+public:
+    enum Type { Null, Number, String, Array, Object };
+
+    Type type = Null;
+    double number = 0;
+    string str;
+    vector<JsonValue> array;
+    vector<pair<string, JsonValue> > object;
+
+    const JsonValue *find(const string &key) const {
+        for (auto &pr : object) {
+            if (pr.first == key) {
+                return &pr.second;
+            }
+        }
+        return nullptr;
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const string &text) : _text(text) {}
+
+    JsonValue parse() {
+        auto ret = parseValue();
+        skipSpace();
+        if (_pos != _text.size()) {
+            throw invalid_argument("unexpected trailing characters");
+        }
+        return ret;
+    }
+
+private:
+    void skipSpace() {
+        while (_pos < _text.size() && isspace((unsigned char)_text[_pos])) {
+            ++_pos;
+        }
+    }
+
+    void expect(char ch) {
+        skipSpace();
+        if (_pos >= _text.size() || _text[_pos] != ch) {
+            throw invalid_argument(string("expect '") + ch + "' at " + to_string(_pos));
+        }
+        ++_pos;
+    }
+
+    string parseString() {
+        expect('"');
+        string ret;
+        while (_pos < _text.size() && _text[_pos] != '"') {
+            if (_text[_pos] == '\\' && _pos + 1 < _text.size()) {
+                ++_pos;
+            }
+            ret.push_back(_text[_pos++]);
+        }
+        expect('"');
+        return ret;
+    }
+
+    JsonValue parseValue() {
+        skipSpace();
+        if (_pos >= _text.size()) {
+            throw invalid_argument("unexpected end of json");
+        }
+        JsonValue ret;
+        auto ch = _text[_pos];
+        if (ch == '{') {
+            ret.type = JsonValue::Object;
+            ++_pos;
+            skipSpace();
+            if (_text[_pos] == '}') {
+                ++_pos;
+                return ret;
+            }
+            while (true) {
+                auto key = parseString();
+                expect(':');
+                ret.object.emplace_back(key, parseValue());
+                skipSpace();
+                if (_text[_pos] == ',') {
+                    ++_pos;
+                    continue;
+                }
+                expect('}');
+                return ret;
+            }
+        }
+        if (ch == '[') {
+            ret.type = JsonValue::Array;
+            ++_pos;
+            skipSpace();
+            if (_text[_pos] == ']') {
+                ++_pos;
+                return ret;
+            }
+            while (true) {
+                ret.array.emplace_back(parseValue());
+                skipSpace();
+                if (_text[_pos] == ',') {
+                    ++_pos;
+                    continue;
+                }
+                expect(']');
+                return ret;
+            }
+        }
+        if (ch == '"') {
+            ret.type = JsonValue::String;
+            ret.str = parseString();
+            return ret;
+        }
+        if (_text.compare(_pos, 4, "null") == 0) {
+            _pos += 4;
+            return ret;
+        }
+        size_t len = 0;
+        ret.type = JsonValue::Number;
+        ret.number = stod(_text.substr(_pos, 64), &len);
+        _pos += len;
+        return ret;
+    }
+
+private:
+    size_t _pos = 0;
+    const string &_text;
+};
+
+class BenchRecord {
+public:
+    double ns_per_op = 0;
+    double allocs_per_op = 0;
+};
+
+static map<string, BenchRecord> loadResult(const char *path) {
+    ifstream in(path);
+    if (!in) {
+        throw invalid_argument(string("open ") + path + " failed");
+    }
+    stringstream ss;
+    ss << in.rdbuf();
+    auto text = ss.str();
+    auto root = JsonParser(text).parse();
+    auto results = root.find("results");
+    if (!results || results->type != JsonValue::Array) {
+        throw invalid_argument(string(path) + " has no results");
+    }
+    map<string, BenchRecord> ret;
+    for (auto &item : results->array) {
+        auto name = item.find("name");
+        auto ns = item.find("ns_per_op");
+        auto allocs = item.find("allocs_per_op");
+        if (!name || !ns) {
+            continue;
+        }
+        auto &record = ret[name->str];
+        record.ns_per_op = ns->number;
+        record.allocs_per_op = allocs ? allocs->number : 0;
+    }
+    return ret;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        cout << "usage: " << argv[0] << " baseline.json current.json [threshold_percent=10]" << endl
+             << "  exit code 1 if any case is slower than baseline by more than threshold_percent," << endl
+             << "  or allocates more per op than baseline" << endl;
+        return 2;
+    }
+    double threshold = argc > 3 ? atof(argv[3]) : 10;
+
+    map<string, BenchRecord> baseline, current;
+    try {
+        baseline = loadResult(argv[1]);
+        current = loadResult(argv[2]);
+    } catch (std::exception &ex) {
+        cerr << "load benchmark result failed: " << ex.what() << endl;
+        return 2;
+    }
+
+    int regressions = 0;
+    cout << left << setw(36) << "case" << right << setw(14) << "base ns/op" << setw(14) << "curr ns/op"
+         << setw(10) << "diff" << setw(16) << "allocs/op" << "  status" << endl;
+    for (auto &pr : current) {
+        auto it = baseline.find(pr.first);
+        if (it == baseline.end()) {
+            cout << left << setw(36) << pr.first << right << setw(14) << "-" << setw(14) << pr.second.ns_per_op
+                 << setw(10) << "-" << setw(16) << pr.second.allocs_per_op << "  NEW" << endl;
+            continue;
+        }
+        auto &base = it->second;
+        auto &curr = pr.second;
+        double diff = base.ns_per_op > 0 ? (curr.ns_per_op - base.ns_per_op) * 100 / base.ns_per_op : 0;
+        bool slower = diff > threshold;
+        //允许浮点误差
+        bool more_alloc = curr.allocs_per_op > base.allocs_per_op + 0.01;
+        if (slower || more_alloc) {
+            ++regressions;
+        }
+        stringstream allocs;
+        allocs << base.allocs_per_op << "->" << curr.allocs_per_op;
+        stringstream diff_str;
+        diff_str << fixed << setprecision(1) << showpos << diff << "%";
+        cout << left << setw(36) << pr.first << right << setw(14) << base.ns_per_op << setw(14) << curr.ns_per_op
+             << setw(10) << diff_str.str() << setw(16) << allocs.str() << "  "
+             << (slower ? "REGRESSION" : (more_alloc ? "MORE ALLOCS" : "ok")) << endl;
+    }
+    for (auto &pr : baseline) {
+        if (current.find(pr.first) == current.end()) {
+            cout << left << setw(36) << pr.first << "  MISSING" << endl;
+        }
+    }
+
+    if (regressions) {
+        cout << regressions << " regression(s) found, threshold: " << threshold << "%" << endl;
+        return 1;
+    }
+    cout << "no regression found, threshold: " << threshold << "%" << endl;
+    return 0;
+}
@@ -0,0 +1,349 @@
+//
+// Created by FFZero on 2025-04-05.
+//
+
+#include <deque>
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+#include "Benchmark.h"
+#include "Util/Histogram.h"
+#include "Util/TimeTicker.h"
+#include "Util/uv_errno.h"
+#include "Network/sockutil.h"
+#include "Poller/EventPoller.h"
+
+using namespace std;
+using namespace FFZKit;
+
+#if defined(HAS_EPOLL)
+#define POLLER_TYPE "epoll"
+#else
+#define POLLER_TYPE "select"
+#endif
+
+//回环tcp echo测试，仅基于SockUtil与EventPoller::addEvent，衡量事件循环本身的io性能
+class EchoConnection {
+public:
+    using Ptr = std::shared_ptr<EchoConnection>;
+
+    int fd = -1;
+    bool connected = false;
+    EventPoller::Ptr poller;
+    // 未发送完毕的数据
+    string out;
+    // 客户端：已收到但未凑满一个消息的字节数
+    size_t partial = 0;
+    // 客户端：在途消息的发送时间
+    deque<uint64_t> send_time;
+};
+
+class EchoBench {
+public:
+    EchoBench(size_t msg_size, size_t depth) : _msg(msg_size, 'e'), _depth(depth) {}
+
+    static uint64_t now() {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    bool startServer(const EventPoller::Ptr &poller) {
+        _listen_fd = SockUtil::listen(0, "127.0.0.1", 4096);
+        if (_listen_fd == -1) {
+            return false;
+        }
+        _port = SockUtil::get_local_port(_listen_fd);
+        return poller->addEvent(_listen_fd, EventPoller::Event_Read, [this](int event) { onAccept(); }) != -1;
+    }
+
+    bool startClient(size_t index) {
+        //每个本地回环ip约可用2.8万个端口，连接数较多时轮换本地ip
+        auto local_ip = "127.0.0." + to_string(1 + index / 25000);
+        auto fd = SockUtil::connect("127.0.0.1", _port, true, local_ip.data());
+        if (fd == -1) {
+            return false;
+        }
+        auto conn = std::make_shared<EchoConnection>();
+        conn->fd = fd;
+        conn->poller = EventPollerPool::Instance().getPoller(false);
+        addConnection(conn, true);
+        return true;
+    }
+
+    void stop() {
+        _running = false;
+        lock_guard<mutex> lck(_mtx);
+        for (auto &conn : _conns) {
+            auto fd = conn->fd;
+            conn->poller->delEvent(fd, [fd](bool) { close(fd); });
+        }
+        _conns.clear();
+        if (_listen_fd != -1) {
+            auto fd = _listen_fd;
+            EventPollerPool::Instance().getFirstPoller()->delEvent(fd, [fd](bool) { close(fd); });
+            _listen_fd = -1;
+        }
+    }
+
+    uint16_t port() const { return _port; }
+    size_t connected() const { return _connected.load(); }
+    uint64_t messages() const { return _messages.load(); }
+    Histogram &histogram() { return _histogram; }
+
+private:
+    void addConnection(const EchoConnection::Ptr &conn, bool client) {
+        {
+            lock_guard<mutex> lck(_mtx);
+            _conns.emplace_back(conn);
+        }
+        // 客户端先监听可写事件以获知连接成功
+        int event = EventPoller::Event_Read | EventPoller::Event_Error | (client ? EventPoller::Event_Write : 0);
+        // 回调持有连接对象，delEvent后释放
+        conn->poller->addEvent(conn->fd, event, [this, conn, client](int event) {
+            auto ptr = conn.get();
+            if (client) {
+                onClientEvent(ptr, event);
+            } else {
+                onServerEvent(ptr, event);
+            }
+        });
+    }
+
+    void onAccept() {
+        while (true) {
+            auto fd = (int) accept(_listen_fd, nullptr, nullptr);
+            if (fd == -1) {
+                break;
+            }
+            SockUtil::setNoBlocked(fd);
+            SockUtil::setNoDelay(fd);
+            SockUtil::setCloExec(fd);
+            auto conn = std::make_shared<EchoConnection>();
+            conn->fd = fd;
+            conn->poller = EventPollerPool::Instance().getPoller(false);
+            addConnection(conn, false);
+        }
+    }
+
+    // 发送数据，发送不完的部分缓存并监听可写事件
+    void sendData(EchoConnection *conn, const char *data, size_t size) {
+        if (!conn->out.empty()) {
+            conn->out.append(data, size);
+            return;
+        }
+        auto sent = ::send(conn->fd, data, size, MSG_NOSIGNAL);
+        if (sent < 0) {
+            sent = 0;
+        }
+        if ((size_t)sent < size) {
+            conn->out.append(data + sent, size - sent);
+            conn->poller->modifyEvent(conn->fd, EventPoller::Event_Read | EventPoller::Event_Write | EventPoller::Event_Error);
+        }
+    }
+
+    bool flushData(EchoConnection *conn) {
+        if (conn->out.empty()) {
+            return true;
+        }
+        auto sent = ::send(conn->fd, conn->out.data(), conn->out.size(), MSG_NOSIGNAL);
+        if (sent > 0) {
+            conn->out.erase(0, sent);
+        }
+        if (conn->out.empty()) {
+            conn->poller->modifyEvent(conn->fd, EventPoller::Event_Read | EventPoller::Event_Error);
+            return true;
+        }
+        return false;
+    }
+
+    static char *recvBuffer() {
+        static thread_local char s_buf[64 * 1024];
+        return s_buf;
+    }
+
+    void onServerEvent(EchoConnection *conn, int event) {
+        if (event & EventPoller::Event_Write) {
+            flushData(conn);
+        }
+        if (!(event & EventPoller::Event_Read)) {
+            return;
+        }
+        auto buf = recvBuffer();
+        while (true) {
+            auto size = ::recv(conn->fd, buf, 64 * 1024, 0);
+            if (size <= 0) {
+                break;
+            }
+            sendData(conn, buf, size);
+        }
+    }
+
+    void sendMessage(EchoConnection *conn) {
+        conn->send_time.emplace_back(now());
+        sendData(conn, _msg.data(), _msg.size());
+    }
+
+    void onClientEvent(EchoConnection *conn, int event) {
+        if (event & EventPoller::Event_Write) {
+            if (!conn->connected) {
+                if (SockUtil::getSockError(conn->fd) != 0) {
+                    return;
+                }
+                conn->connected = true;
+                ++_connected;
+                conn->poller->modifyEvent(conn->fd, EventPoller::Event_Read | EventPoller::Event_Error);
+                for (size_t i = 0; i < _depth; ++i) {
+                    sendMessage(conn);
+                }
+            } else {
+                flushData(conn);
+            }
+        }
+        if (!(event & EventPoller::Event_Read)) {
+            return;
+        }
+        auto buf = recvBuffer();
+        while (true) {
+            auto size = ::recv(conn->fd, buf, 64 * 1024, 0);
+            if (size <= 0) {
+                break;
+            }
+            conn->partial += size;
+            while (conn->partial >= _msg.size() && !conn->send_time.empty()) {
+                conn->partial -= _msg.size();
+                _histogram.record(now() - conn->send_time.front());
+                conn->send_time.pop_front();
+                ++_messages;
+                if (_running) {
+                    sendMessage(conn);
+                }
+            }
+        }
+    }
+
+private:
+    string _msg;
+    size_t _depth;
+    int _listen_fd = -1;
+    uint16_t _port = 0;
+    atomic<bool> _running { true };
+    atomic<size_t> _connected { 0 };
+    atomic<uint64_t> _messages { 0 };
+    Histogram _histogram;
+    mutex _mtx;
+    vector<EchoConnection::Ptr> _conns;
+};
+
+//汇总所有poller的modifyEvent统计
+static void getModifyStatistic(uint64_t &requested, uint64_t &applied) {
+    requested = applied = 0;
+    EventPollerPool::Instance().for_each([&](const TaskExecutor::Ptr &executor) {
+        uint64_t req, app;
+        static_pointer_cast<EventPoller>(executor)->getModifyStatistic(req, app);
+        requested += req;
+        applied += app;
+    });
+}
+
+static void raiseFdLimit() {
+#if !defined(_WIN32)
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+#endif
+}
+
+int main(int argc, char *argv[]) {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+
+    CMD_benchmark cmd("bench_echo.json");
+    cmd << Option('c', "connections", Option::ArgRequired, "1", false, "number of client connections (1 ~ 100000)", nullptr);
+    cmd << Option('m', "size", Option::ArgRequired, "64", false, "message size in bytes", nullptr);
+    cmd << Option('d', "depth", Option::ArgRequired, "1", false, "pipelining depth per connection", nullptr);
+    cmd << Option('T', "duration", Option::ArgRequired, "5", false, "test duration in seconds", nullptr);
+    cmd << Option('p', "pollers", Option::ArgRequired, "0", false, "number of pollers, 0 for cpu count", nullptr);
+    cmd << Option('b', "batch_modify", Option::ArgRequired, "0", false, "batch epoll_ctl(MOD) before each wait (1) or not (0)", nullptr);
+    try {
+        cmd(argc, argv);
+    } catch (std::exception &ex) {
+        cout << ex.what() << endl;
+        return 0;
+    }
+
+    size_t connections = cmd["connections"];
+    size_t msg_size = cmd["size"];
+    size_t depth = cmd["depth"];
+    int duration = cmd["duration"];
+    connections = connections ? connections : 1;
+    msg_size = msg_size ? msg_size : 1;
+    depth = depth ? depth : 1;
+
+    raiseFdLimit();
+    EventPollerPool::setPoolSize(cmd["pollers"].as<size_t>());
+
+    bool batch_modify = cmd["batch_modify"];
+    EventPollerPool::Instance().for_each([&](const TaskExecutor::Ptr &executor) {
+        static_pointer_cast<EventPoller>(executor)->enableBatchModify(batch_modify);
+    });
+
+    EchoBench echo(msg_size, depth);
+    if (!echo.startServer(EventPollerPool::Instance().getFirstPoller())) {
+        ErrorL << "start echo server failed: " << get_uv_errmsg();
+        return -1;
+    }
+    InfoL << "echo server (" << POLLER_TYPE << ") listen on 127.0.0.1:" << echo.port();
+
+    for (size_t i = 0; i < connections; ++i) {
+        if (!echo.startClient(i)) {
+            ErrorL << "connect failed after " << i << " connections: " << get_uv_errmsg();
+            break;
+        }
+    }
+
+    //跳过建连阶段
+    Ticker ticker;
+    while (echo.connected() < connections && ticker.elapsedTime() < 10 * 1000) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    InfoL << "connected: " << echo.connected() << " cost " << ticker.elapsedTime() << "ms";
+    echo.histogram().reset();
+    auto messages = echo.messages();
+    auto allocs = s_bench_alloc_count.load();
+    uint64_t modify_requested = 0, modify_applied = 0;
+    getModifyStatistic(modify_requested, modify_applied);
+    auto start = EchoBench::now();
+    this_thread::sleep_for(chrono::seconds(duration));
+    messages = echo.messages() - messages;
+    auto ns = EchoBench::now() - start;
+    allocs = s_bench_alloc_count.load() - allocs;
+    uint64_t requested = 0, applied = 0;
+    getModifyStatistic(requested, applied);
+    modify_requested = requested - modify_requested;
+    modify_applied = applied - modify_applied;
+    echo.stop();
+
+    auto &histogram = echo.histogram();
+    BenchResult result;
+    result.name = StrPrinter << "tcp echo " << POLLER_TYPE << " c" << echo.connected() << " m" << msg_size << " d" << depth << (batch_modify ? " batch" : "");
+    result.threads = EventPollerPool::Instance().getExecutorSize();
+    result.iterations = messages;
+    result.ns_per_op = messages ? (double)ns / messages : 0;
+    result.ops_per_sec = messages * 1e9 / ns;
+    result.allocs_per_op = messages ? (double)allocs / messages : 0;
+    result.metrics.emplace_back("MB_per_sec", result.ops_per_sec * msg_size / (1024 * 1024));
+    result.metrics.emplace_back("p50_us", histogram.percentile(50) / 1000.0);
+    result.metrics.emplace_back("p99_us", histogram.percentile(99) / 1000.0);
+    result.metrics.emplace_back("p99.9_us", histogram.percentile(99.9) / 1000.0);
+    result.metrics.emplace_back("max_us", histogram.max() / 1000.0);
+    result.metrics.emplace_back("modify_per_op", messages ? (double)modify_requested / messages : 0);
+    result.metrics.emplace_back("epoll_ctl_per_op", messages ? (double)modify_applied / messages : 0);
+
+    Benchmark bench("bench_echo");
+    bench.addResult(std::move(result));
+    bench.save(cmd["out"]);
+    //等待连接关闭
+    this_thread::sleep_for(chrono::milliseconds(200));
+    return 0;
+}
@@ -0,0 +1,335 @@
+//
+// Created by FFZero on 2025-04-12.
+//
+
+#include <fstream>
+#if !defined(_WIN32)
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#endif
+
+#include "Benchmark.h"
+#include "Util/Histogram.h"
+#include "Util/uv_errno.h"
+#include "Thread/semaphore.h"
+#include "Network/sockutil.h"
+#include "Poller/EventPoller.h"
+
+using namespace std;
+using namespace FFZKit;
+
+//合成负载生成器：按配置向EventPollerPool施加空闲fd、活跃fd、定时器、跨线程任务、日志等混合负载，
+//周期性打印各poller负载、任务执行延时、定时器触发迟滞以及常驻内存，用于评估单机容量
+
+class LoadLogger : public Logger {
+public:
+    LoadLogger() : Logger("loadgen") {}
+};
+
+//丢弃日志但保留格式化开销
+class NullChannel : public LogChannel {
+public:
+    NullChannel() : LogChannel("NullChannel") {}
+
+    void write(const Logger &logger, const LogContextPtr &ctx) override {
+        std::ostringstream ss;
+        format(logger, ss, ctx);
+    }
+};
+
+static uint64_t nowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double getRssMB() {
+#if defined(__linux__)
+    ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return (double)resident * sysconf(_SC_PAGESIZE) / (1024 * 1024);
+#else
+    return 0;
+#endif
+}
+
+static void raiseFdLimit() {
+#if !defined(_WIN32)
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+#endif
+}
+
+class LoadGenerator {
+public:
+    LoadGenerator() {
+        _logger.add(std::make_shared<NullChannel>());
+        _logger.setWriter(std::make_shared<AsyncLogWriter>());
+        EventPollerPool::Instance().for_each([&](const TaskExecutor::Ptr &executor) {
+            _pollers.emplace_back(static_pointer_cast<EventPoller>(executor));
+        });
+    }
+
+    ~LoadGenerator() {
+        stop();
+    }
+
+    /**
+     * 创建fd对并监听读端
+     * @param count fd对个数
+     * @param active 是否为活跃fd(由驱动线程写入数据)
+     */
+    size_t addFds(size_t count, bool active) {
+        for (size_t i = 0; i < count; ++i) {
+            int fds[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1) {
+                WarnL << "socketpair failed after " << i << " pairs: " << get_uv_errmsg();
+                return i;
+            }
+            SockUtil::setNoBlocked(fds[0]);
+            SockUtil::setNoBlocked(fds[1]);
+            auto &poller = _pollers[_fd_pos++ % _pollers.size()];
+            auto fd = fds[0];
+            poller->addEvent(fd, EventPoller::Event_Read, [this, fd](int event) {
+                char buf[256];
+                while (::recv(fd, buf, sizeof(buf), 0) > 0) {
+                    ++_active_reads;
+                }
+            });
+            _fds.emplace_back(poller, fds[0], fds[1]);
+            if (active) {
+                _active_fds.emplace_back(fds[1]);
+            }
+        }
+        return count;
+    }
+
+    /**
+     * 添加周期定时器，首次触发时间在一个周期内均匀打散
+     */
+    void addTimers(size_t count, uint64_t interval_ms) {
+        for (size_t i = 0; i < count; ++i) {
+            auto &poller = _pollers[i % _pollers.size()];
+            auto first_delay = 1 + (interval_ms * i / (count ? count : 1)) % interval_ms;
+            auto expected = std::make_shared<uint64_t>(nowNs() + first_delay * 1000000);
+            _timers.emplace_back(poller->doDelayTask(first_delay, [this, expected, interval_ms]() {
+                auto now = nowNs();
+                // 迟滞为实际触发时间与预期触发时间之差(毫秒级定时器，至多有1ms的量化误差)
+                auto late = now > *expected ? now - *expected : 0;
+                _lateness.record(late);
+                _lateness_total.record(late);
+                *expected = now + interval_ms * 1000000;
+                return interval_ms;
+            }));
+        }
+    }
+
+    /**
+     * 每个poller上以10ms为周期输出日志，平摊总的日志速率
+     */
+    void addLogger(uint64_t lines_per_sec) {
+        if (!lines_per_sec) {
+            return;
+        }
+        for (size_t i = 0; i < _pollers.size(); ++i) {
+            auto share = std::make_shared<double>(0);
+            double per_tick = (double)lines_per_sec / _pollers.size() / 100;
+            _timers.emplace_back(_pollers[i]->doDelayTask(10, [this, share, per_tick]() {
+                *share += per_tick;
+                for (; *share >= 1; *share -= 1) {
+                    LogContextCapture(_logger, LInfo, __FILE__, __FUNCTION__, __LINE__) << "load generator log line " << _log_lines++;
+                }
+                return 10;
+            }));
+        }
+    }
+
+    /**
+     * 启动驱动线程，按速率写活跃fd以及投递跨线程任务
+     */
+    void startDriver(uint64_t write_rate, uint64_t task_rate) {
+        _driver = thread([this, write_rate, task_rate]() {
+            setThreadName("loadgen driver");
+            auto start = nowNs();
+            uint64_t writes = 0, tasks = 0;
+            size_t write_pos = 0, task_pos = 0;
+            while (!_exit) {
+                this_thread::sleep_for(chrono::milliseconds(1));
+                auto elapsed = nowNs() - start;
+                auto write_target = !_active_fds.empty() ? (uint64_t)(write_rate * elapsed / 1e9) : 0;
+                for (; writes < write_target; ++writes) {
+                    ::send(_active_fds[write_pos++ % _active_fds.size()], "x", 1, MSG_NOSIGNAL);
+                }
+                auto task_target = (uint64_t)(task_rate * elapsed / 1e9);
+                for (; tasks < task_target; ++tasks) {
+                    _pollers[task_pos++ % _pollers.size()]->async([this]() { ++_tasks_done; }, false);
+                }
+            }
+        });
+    }
+
+    void stop() {
+        if (_exit.exchange(true)) {
+            return;
+        }
+        if (_driver.joinable()) {
+            _driver.join();
+        }
+        for (auto &timer : _timers) {
+            timer->cancel();
+        }
+        _timers.clear();
+        for (auto &item : _fds) {
+            auto read_fd = get<1>(item);
+            auto write_fd = get<2>(item);
+            get<0>(item)->delEvent(read_fd, [read_fd, write_fd](bool) {
+                close(read_fd);
+                close(write_fd);
+            });
+        }
+        _fds.clear();
+        _active_fds.clear();
+    }
+
+    /**
+     * 同步获取各poller的任务执行延时(毫秒)
+     */
+    vector<int> getDelay() {
+        vector<int> ret;
+        semaphore sem;
+        EventPollerPool::Instance().getExecutorDelay([&](const vector<int> &delay) {
+            ret = delay;
+            sem.post();
+        });
+        sem.wait();
+        return ret;
+    }
+
+    Histogram &lateness() { return _lateness; }
+    Histogram &latenessTotal() { return _lateness_total; }
+    uint64_t activeReads() const { return _active_reads; }
+    uint64_t tasksDone() const { return _tasks_done; }
+    uint64_t logLines() const { return _log_lines; }
+
+private:
+    atomic<bool> _exit { false };
+    atomic<uint64_t> _active_reads { 0 };
+    atomic<uint64_t> _tasks_done { 0 };
+    atomic<uint64_t> _log_lines { 0 };
+    size_t _fd_pos = 0;
+    thread _driver;
+    LoadLogger _logger;
+    // 当前统计周期与全程的定时器迟滞，单位纳秒
+    Histogram _lateness;
+    Histogram _lateness_total;
+    vector<EventPoller::Ptr> _pollers;
+    vector<tuple<EventPoller::Ptr, int, int> > _fds;
+    vector<int> _active_fds;
+    vector<EventPoller::DelayTask::Ptr> _timers;
+};
+
+template<typename T>
+static string join(const vector<T> &vec) {
+    _StrPrinter printer;
+    for (auto &item : vec) {
+        printer << item << " ";
+    }
+    return printer;
+}
+
+int main(int argc, char *argv[]) {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+
+    CMD_benchmark cmd("bench_loadgen.json");
+    cmd << Option('p', "pollers", Option::ArgRequired, "0", false, "number of pollers, 0 for cpu count", nullptr);
+    cmd << Option('i', "idle", Option::ArgRequired, "10000", false, "number of idle fds (socket pairs)", nullptr);
+    cmd << Option('a', "active", Option::ArgRequired, "100", false, "number of active fds (socket pairs)", nullptr);
+    cmd << Option('w', "write_rate", Option::ArgRequired, "10000", false, "total writes per second to active fds", nullptr);
+    cmd << Option('n', "timers", Option::ArgRequired, "10000", false, "number of periodic timers", nullptr);
+    cmd << Option('r', "timer_interval", Option::ArgRequired, "100", false, "timer interval in milliseconds", nullptr);
+    cmd << Option('x', "task_rate", Option::ArgRequired, "10000", false, "cross-thread tasks per second", nullptr);
+    cmd << Option('l', "log_rate", Option::ArgRequired, "1000", false, "log lines per second", nullptr);
+    cmd << Option('T', "duration", Option::ArgRequired, "10", false, "test duration in seconds", nullptr);
+    cmd << Option('I', "interval", Option::ArgRequired, "1", false, "report interval in seconds", nullptr);
+    try {
+        cmd(argc, argv);
+    } catch (std::exception &ex) {
+        cout << ex.what() << endl;
+        return 0;
+    }
+
+    uint64_t timer_interval = cmd["timer_interval"];
+    timer_interval = timer_interval ? timer_interval : 1;
+    int duration = cmd["duration"];
+    int interval = cmd["interval"];
+    interval = interval > 0 ? interval : 1;
+
+    raiseFdLimit();
+    EventPollerPool::setPoolSize(cmd["pollers"].as<size_t>());
+    auto rss_base = getRssMB();
+
+    LoadGenerator load;
+    auto idle = load.addFds(cmd["idle"], false);
+    auto active = load.addFds(cmd["active"], true);
+    load.addTimers(cmd["timers"], timer_interval);
+    load.addLogger(cmd["log_rate"]);
+    load.startDriver(cmd["write_rate"], cmd["task_rate"]);
+    InfoL << "pollers: " << EventPollerPool::Instance().getExecutorSize() << ", idle fds: " << idle << ", active fds: " << active
+          << ", timers: " << cmd["timers"] << " every " << timer_interval << "ms";
+
+    double rss_peak = 0;
+    int delay_max = 0;
+    int load_max = 0;
+    auto reads = load.activeReads();
+    auto tasks = load.tasksDone();
+    auto lines = load.logLines();
+    for (int elapsed = interval; elapsed <= duration; elapsed += interval) {
+        this_thread::sleep_for(chrono::seconds(interval));
+        auto delay = load.getDelay();
+        auto loads = EventPollerPool::Instance().getExecutorLoad();
+        auto rss = getRssMB();
+        auto &lateness = load.lateness();
+        rss_peak = (std::max)(rss_peak, rss);
+        for (auto item : delay) {
+            delay_max = (std::max)(delay_max, item);
+        }
+        for (auto item : loads) {
+            load_max = (std::max)(load_max, item);
+        }
+        InfoL << "[" << elapsed << "s] rss: " << rss << "MB"
+              << ", timer late p50/p99/max: " << lateness.percentile(50) / 1e6 << "/" << lateness.percentile(99) / 1e6 << "/" << lateness.max() / 1e6 << "ms"
+              << ", reads/s: " << (load.activeReads() - reads) / interval
+              << ", tasks/s: " << (load.tasksDone() - tasks) / interval
+              << ", logs/s: " << (load.logLines() - lines) / interval
+              << ", load(%): " << join(loads) << ", delay(ms): " << join(delay);
+        lateness.reset();
+        reads = load.activeReads();
+        tasks = load.tasksDone();
+        lines = load.logLines();
+    }
+    load.stop();
+
+    auto &lateness = load.latenessTotal();
+    BenchResult result;
+    result.name = StrPrinter << "loadgen i" << idle << " a" << active << " n" << cmd["timers"] << " r" << timer_interval;
+    result.threads = EventPollerPool::Instance().getExecutorSize();
+    result.iterations = lateness.count();
+    result.ns_per_op = lateness.mean();
+    result.metrics.emplace_back("rss_mb", rss_peak);
+    result.metrics.emplace_back("rss_per_fd_kb", idle + active ? (rss_peak - rss_base) * 1024 / (idle + active) : 0);
+    result.metrics.emplace_back("late_p50_ms", lateness.percentile(50) / 1e6);
+    result.metrics.emplace_back("late_p99_ms", lateness.percentile(99) / 1e6);
+    result.metrics.emplace_back("late_max_ms", lateness.max() / 1e6);
+    result.metrics.emplace_back("delay_max_ms", delay_max);
+    result.metrics.emplace_back("load_max", load_max);
+
+    Benchmark bench("bench_loadgen");
+    bench.addResult(std::move(result));
+    bench.save(cmd["out"]);
+    //等待fd关闭
+    this_thread::sleep_for(chrono::milliseconds(200));
+    return 0;
+}
@@ -0,0 +1,137 @@
+//
+// Created by FFZero on 2025-03-29.
+//
+
+#include "Benchmark.h"
+#include "Util/Histogram.h"
+#include "Thread/ThreadPool.h"
+#include "Thread/semaphore.h"
+#include "Poller/EventPoller.h"
+
+using namespace std;
+using namespace FFZKit;
+
+//跨线程唤醒延时测试：令牌通过async在多个线程间传递一圈，统计往返延时
+class PingPong : public std::enable_shared_from_this<PingPong> {
+public:
+    using Ptr = std::shared_ptr<PingPong>;
+
+    /**
+     * @param ring 令牌依次经过的执行器，ring[0]为发起方
+     * @param rounds 往返次数
+     */
+    PingPong(vector<TaskExecutor::Ptr> ring, uint64_t rounds) : _ring(std::move(ring)), _rounds(rounds) {}
+
+    void run() {
+        auto self = shared_from_this();
+        _ring[0]->async([self]() { self->start(); }, false);
+        _sem.wait();
+    }
+
+    const Histogram &histogram() const {
+        return _histogram;
+    }
+
+private:
+    static uint64_t now() {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void start() {
+        _start = now();
+        pass(1);
+    }
+
+    //在_ring[index - 1]上执行，最后一跳投递回_ring[0]
+    void pass(size_t index) {
+        auto self = shared_from_this();
+        if (index == _ring.size() + 1) {
+            //回到发起方，一次往返结束
+            _histogram.record(now() - _start);
+            if (++_done == _rounds) {
+                _sem.post();
+                return;
+            }
+            start();
+            return;
+        }
+        _ring[index % _ring.size()]->async([self, index]() { self->pass(index + 1); }, false);
+    }
+
+private:
+    vector<TaskExecutor::Ptr> _ring;
+    uint64_t _rounds;
+    uint64_t _done = 0;
+    uint64_t _start = 0;
+    semaphore _sem;
+    Histogram _histogram;
+};
+
+static void runPingPong(Benchmark &bench, const string &name, vector<TaskExecutor::Ptr> ring, uint64_t rounds) {
+    auto allocs = s_bench_alloc_count.load();
+    auto bytes = s_bench_alloc_bytes.load();
+    auto threads = ring.size();
+    auto ping_pong = std::make_shared<PingPong>(std::move(ring), rounds);
+    ping_pong->run();
+
+    auto &histogram = ping_pong->histogram();
+    BenchResult result;
+    result.name = name;
+    result.threads = threads;
+    result.iterations = rounds;
+    result.ns_per_op = (double)histogram.mean();
+    result.ops_per_sec = histogram.mean() ? 1e9 / histogram.mean() : 0;
+    result.allocs_per_op = (double)(s_bench_alloc_count.load() - allocs) / rounds;
+    result.bytes_per_op = (double)(s_bench_alloc_bytes.load() - bytes) / rounds;
+    result.metrics.emplace_back("p50_us", histogram.percentile(50) / 1000.0);
+    result.metrics.emplace_back("p99_us", histogram.percentile(99) / 1000.0);
+    result.metrics.emplace_back("p99.9_us", histogram.percentile(99.9) / 1000.0);
+    result.metrics.emplace_back("max_us", histogram.max() / 1000.0);
+    bench.addResult(std::move(result));
+}
+
+int main(int argc, char *argv[]) {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+
+    CMD_benchmark cmd("bench_pingpong.json");
+    cmd << Option('a', "affinity", Option::ArgRequired, "1", false, "bind poller/worker threads to cpu (1) or not (0)", nullptr);
+    cmd << Option('p', "pollers", Option::ArgRequired, "2", false, "number of pollers the token passes through", nullptr);
+    cmd << Option('r', "rounds", Option::ArgRequired, "100000", false, "round trips per case", nullptr);
+    try {
+        cmd(argc, argv);
+    } catch (std::exception &ex) {
+        cout << ex.what() << endl;
+        return 0;
+    }
+
+    bool affinity = cmd["affinity"];
+    size_t pollers = cmd["pollers"];
+    pollers = pollers < 2 ? 2 : pollers;
+    uint64_t rounds = (uint64_t)(cmd["rounds"].as<uint64_t>() * cmd["scale"].as<double>());
+    rounds = rounds ? rounds : 1;
+    auto suffix = string(affinity ? " (pinned)" : " (unpinned)");
+
+    //必须在EventPollerPool单例创建前设置
+    EventPollerPool::setPoolSize(pollers);
+    EventPollerPool::enableCpuAffinity(affinity);
+
+    vector<TaskExecutor::Ptr> ring;
+    EventPollerPool::Instance().for_each([&](const TaskExecutor::Ptr &executor) {
+        ring.emplace_back(executor);
+    });
+
+    Benchmark bench("bench_pingpong");
+    auto filter = cmd["filter"];
+    if (filter.empty() || string("poller<->poller").find(filter) != string::npos) {
+        runPingPong(bench, "poller<->poller" + suffix, { ring[0], ring[1] }, rounds);
+    }
+    if (ring.size() > 2 && (filter.empty() || string("poller ring").find(filter) != string::npos)) {
+        runPingPong(bench, "poller ring x" + to_string(ring.size()) + suffix, ring, rounds);
+    }
+    if (filter.empty() || string("poller<->thread_pool").find(filter) != string::npos) {
+        auto pool = std::make_shared<ThreadPool>(cmd["threads"].as<int>(), ThreadPool::PRIORITY_HIGHEST, true, affinity);
+        runPingPong(bench, "poller<->thread_pool" + suffix, { ring[0], pool }, rounds);
+    }
+    bench.save(cmd["out"]);
+    return 0;
+}
@@ -0,0 +1,305 @@
+//
+// Created by FFZero on 2025-03-22.
+//
+
+#include "Benchmark.h"
+#include "Util/NoticeCenter.h"
+#include "Util/ResourcePool.h"
+#include "Network/Buffer.h"
+#include "Network/BufferSock.h"
+#include "Thread/ThreadPool.h"
+#include "Thread/semaphore.h"
+#include "Poller/EventPoller.h"
+
+using namespace std;
+using namespace FFZKit;
+
+#define BENCH_EVENT "kBenchEvent"
+
+//日志基准测试使用独立的Logger实例，避免影响全局日志输出
+class BenchLogger : public Logger {
+public:
+    BenchLogger() : Logger("bench") {}
+};
+
+//丢弃日志但保留格式化开销
+class NullChannel : public LogChannel {
+public:
+    NullChannel() : LogChannel("NullChannel") {}
+
+    void write(const Logger &logger, const LogContextPtr &ctx) override {
+        std::ostringstream ss;
+        format(logger, ss, ctx);
+    }
+};
+
+class PoolItem {
+public:
+    char data[64];
+};
+
+static void addThreadPoolCase(Benchmark &bench) {
+    bench.add("ThreadPool::async", 1000 * 1000, [](uint64_t iterations) {
+        ThreadPool pool(1, ThreadPool::PRIORITY_HIGHEST, true, false);
+        semaphore sem;
+        atomic<uint64_t> count(0);
+        for (uint64_t i = 0; i < iterations; ++i) {
+            pool.async([&]() {
+                if (++count == iterations) {
+                    sem.post();
+                }
+            });
+        }
+        sem.wait();
+    });
+}
+
+static void addEventPollerCase(Benchmark &bench) {
+    bench.add("EventPoller::async cross-thread", 1000 * 1000, [](uint64_t iterations) {
+        auto poller = EventPollerPool::Instance().getPoller(false);
+        semaphore sem;
+        uint64_t count = 0;
+        for (uint64_t i = 0; i < iterations; ++i) {
+            poller->async([&]() {
+                if (++count == iterations) {
+                    sem.post();
+                }
+            });
+        }
+        sem.wait();
+    });
+
+    bench.add("EventPoller::doDelayTask", 200 * 1000, [](uint64_t iterations) {
+        auto poller = EventPollerPool::Instance().getPoller(false);
+        semaphore sem;
+        uint64_t count = 0;
+        poller->async([&]() {
+            //在poller线程插入，1ms后全部到期
+            for (uint64_t i = 0; i < iterations; ++i) {
+                poller->doDelayTask(1, [&]() -> uint64_t {
+                    if (++count == iterations) {
+                        sem.post();
+                    }
+                    return 0;
+                });
+            }
+        });
+        sem.wait();
+    });
+}
+
+static void addLoggerCase(Benchmark &bench, size_t threads) {
+    bench.add("Logger::write", 200 * 1000, [threads](uint64_t iterations) {
+        BenchLogger logger;
+        logger.add(std::make_shared<NullChannel>());
+        logger.setWriter(std::make_shared<AsyncLogWriter>());
+        vector<thread> workers;
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([&logger, iterations, threads, i]() {
+                for (uint64_t n = i; n < iterations; n += threads) {
+                    LogContextCapture(logger, LInfo, __FILE__, __FUNCTION__, __LINE__) << "bench log " << n;
+                }
+            });
+        }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        //销毁异步写线程，等待日志全部落地
+        logger.setWriter(nullptr);
+    }, threads);
+}
+
+static void addUtilCase(Benchmark &bench) {
+    bench.add("ResourcePool::obtain2", 5 * 1000 * 1000, [](uint64_t iterations) {
+        static ResourcePool<PoolItem> pool;
+        for (uint64_t i = 0; i < iterations; ++i) {
+            auto item = pool.obtain2();
+            item->data[0] = (char)i;
+        }
+    });
+
+    bench.add("BufferRaw::create", 5 * 1000 * 1000, [](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; ++i) {
+            auto buffer = BufferRaw::create(1024);
+            buffer->setSize(1);
+        }
+    });
+
+    bench.add("NoticeCenter::emitEvent", 2 * 1000 * 1000, [](uint64_t iterations) {
+        static int tag;
+        uint64_t sum = 0;
+        NoticeCenter::Instance().addListener(&tag, BENCH_EVENT, [&sum](uint64_t &value) {
+            sum += value;
+        });
+        for (uint64_t i = 0; i < iterations; ++i) {
+            NoticeCenter::Instance().emitEvent(BENCH_EVENT, i);
+        }
+        NoticeCenter::Instance().delListener(&tag, BENCH_EVENT);
+    });
+
+    bench.add("Any::set/copy/get", 5 * 1000 * 1000, [](uint64_t iterations) {
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < iterations; ++i) {
+            Any any;
+            any.set<uint64_t>(i);
+            Any copy = any;
+            sum += copy.get<uint64_t>();
+        }
+        if (sum == 1) {
+            InfoL << sum;
+        }
+    });
+}
+
+//socketpair发送端，内核缓存写满时由接收端读空
+class SendPair {
+public:
+    SendPair() {
+        socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+        SockUtil::setNoBlocked(fds[0]);
+        SockUtil::setNoBlocked(fds[1]);
+    }
+
+    ~SendPair() {
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    void drain() {
+        char buf[64 * 1024];
+        while (::recv(fds[1], buf, sizeof(buf), 0) > 0) {}
+    }
+
+    int fds[2];
+};
+
+static void addSendCase(Benchmark &bench) {
+    static const size_t kMsgSize = 64;
+    static const size_t kBatch = 64;
+
+    bench.add("send 64B per buffer", 2 * 1000 * 1000, [](uint64_t iterations) {
+        SendPair pair;
+        for (uint64_t i = 0; i < iterations; ++i) {
+            auto buffer = BufferRaw::create(kMsgSize);
+            buffer->setSize(kMsgSize);
+            while (::send(pair.fds[0], buffer->data(), buffer->size(), 0) == -1) {
+                pair.drain();
+            }
+        }
+    });
+
+    bench.add("BufferList 64B x 64 sendmsg", 2 * 1000 * 1000, [](uint64_t iterations) {
+        SendPair pair;
+        auto list = BufferList::create();
+        for (uint64_t i = 0; i < iterations;) {
+            auto n = (std::min)((uint64_t)kBatch, iterations - i);
+            for (uint64_t j = 0; j < n; ++j) {
+                auto buffer = BufferRaw::create(kMsgSize);
+                buffer->setSize(kMsgSize);
+                list->append(std::move(buffer));
+            }
+            i += n;
+            while (!list->empty()) {
+                if (list->send(pair.fds[0], 0) == -1) {
+                    pair.drain();
+                }
+            }
+        }
+    });
+}
+
+//回环udp收发端，接收端不读取，内核缓存满后数据报被丢弃，只统计发送开销
+class UdpPair {
+public:
+    UdpPair() {
+        recv_fd = SockUtil::bindUdpSock(0, "127.0.0.1");
+        send_fd = SockUtil::bindUdpSock(0, "127.0.0.1");
+        addr = SockUtil::make_sockaddr("127.0.0.1", SockUtil::get_local_port(recv_fd));
+    }
+
+    ~UdpPair() {
+        close(recv_fd);
+        close(send_fd);
+    }
+
+    int recv_fd;
+    int send_fd;
+    struct sockaddr_storage addr;
+};
+
+static void addUdpSendCase(Benchmark &bench) {
+    static const size_t kMsgSize = 200;
+    static const size_t kBatch = 64;
+
+    bench.add("sendto 200B per datagram", 1000 * 1000, [](uint64_t iterations) {
+        UdpPair pair;
+        auto addr_len = SockUtil::get_sock_len((struct sockaddr *)&pair.addr);
+        auto buffer = BufferRaw::create(kMsgSize);
+        buffer->setSize(kMsgSize);
+        for (uint64_t i = 0; i < iterations; ++i) {
+            ::sendto(pair.send_fd, buffer->data(), buffer->size(), 0, (struct sockaddr *)&pair.addr, addr_len);
+        }
+    });
+
+    bench.add("BufferList udp 200B x 64", 1000 * 1000, [](uint64_t iterations) {
+        UdpPair pair;
+        auto list = BufferList::create(true);
+        //同一数据报发往同一目标，只统计发送缓存与系统调用开销
+        auto buffer = BufferRaw::create(kMsgSize);
+        buffer->setSize(kMsgSize);
+        auto packet = std::make_shared<BufferSock>(buffer, (struct sockaddr *)&pair.addr);
+        for (uint64_t i = 0; i < iterations;) {
+            auto n = (std::min)((uint64_t)kBatch, iterations - i);
+            for (uint64_t j = 0; j < n; ++j) {
+                list->append(packet);
+            }
+            i += n;
+            while (!list->empty()) {
+                list->send(pair.send_fd, 0);
+            }
+        }
+    });
+
+    bench.add("BufferList udp gso 200B x 64", 1000 * 1000, [](uint64_t iterations) {
+        UdpPair pair;
+        if (-1 == SockUtil::setUdpSegment(pair.send_fd, kMsgSize)) {
+            return;
+        }
+        auto list = BufferList::create(true);
+        //一个Buffer由内核切分为kBatch个数据报
+        auto buffer = BufferRaw::create(kMsgSize * kBatch);
+        buffer->setSize(kMsgSize * kBatch);
+        auto packet = std::make_shared<BufferSock>(buffer, (struct sockaddr *)&pair.addr);
+        for (uint64_t i = 0; i < iterations; i += kBatch) {
+            list->append(packet);
+            while (!list->empty()) {
+                list->send(pair.send_fd, 0);
+            }
+        }
+    });
+}
+
+int main(int argc, char *argv[]) {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+
+    CMD_benchmark cmd("bench_suite.json");
+    try {
+        cmd(argc, argv);
+    } catch (std::exception &ex) {
+        cout << ex.what() << endl;
+        return 0;
+    }
+
+    size_t threads = cmd["threads"];
+    Benchmark bench("bench_suite");
+    addThreadPoolCase(bench);
+    addEventPollerCase(bench);
+    addLoggerCase(bench, threads ? threads : 1);
+    addUtilCase(bench);
+    addSendCase(bench);
+    addUdpSendCase(bench);
+
+    bench.run(cmd["filter"], cmd["scale"]);
+    bench.save(cmd["out"]);
+    return 0;
+}
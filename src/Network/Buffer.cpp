@@ -5,6 +5,7 @@ namespace FFZKit {
 
 StatisticImp(Buffer)
 StatisticImp(BufferRaw)
+StatisticImp(BufferOffset)
     
 BufferRaw::Ptr BufferRaw::create(size_t size) {
 #if 1
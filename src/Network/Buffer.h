@@ -121,6 +121,40 @@ private:
     ObjectStatistic<BufferRaw> statistic_;
 };
 
+//缓存视图，引用另一个Buffer中的一段数据，不拷贝
+//持有原Buffer的引用，在视图释放前原Buffer不会被回收
+class BufferOffset : public Buffer {
+public:
+    using Ptr = std::shared_ptr<BufferOffset>;
+
+    BufferOffset(Buffer::Ptr buffer, size_t offset = 0, size_t len = 0) : buffer_(std::move(buffer)) {
+        auto total = buffer_->size();
+        if (offset > total) {
+            offset = total;
+        }
+        if (!len || len > total - offset) {
+            //len为0或越界时，引用至原Buffer末尾
+            len = total - offset;
+        }
+        offset_ = offset;
+        size_ = len;
+    }
+
+    char* data() const override {
+        return buffer_->data() + offset_;
+    }
+
+    size_t size() const override {
+        return size_;
+    }
+
+private:
+    size_t offset_ = 0;
+    size_t size_ = 0;
+    Buffer::Ptr buffer_;
+    ObjectStatistic<BufferOffset> statistic_;
+};
+
 } // namespace FFZKit
 
 
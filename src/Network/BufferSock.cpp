@@ -0,0 +1,775 @@
+//
+// Created by FFZero on 2025-05-24.
+//
+
+#include "BufferSock.h"
+#include "Util/uv_errno.h"
+#include "Util/logger.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(__linux__) || defined(__linux)
+#include <sys/sendfile.h>
+#include <linux/errqueue.h>
+#if !defined(MSG_ZEROCOPY)
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#if !defined(SO_EE_ORIGIN_ZEROCOPY)
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#if !defined(SO_EE_CODE_ZEROCOPY_COPIED)
+#define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif
+#endif
+
+using namespace std;
+
+namespace FFZKit {
+
+//tcp接收缓存大小
+static constexpr size_t kTcpRecvSize = 256 * 1024;
+//udp接收缓存大小，不使用recvmmsg时一次只读取一个数据报
+static constexpr size_t kUdpRecvSize = 64 * 1024;
+//recvmmsg一次最多读取的数据报个数及每个数据报的缓存大小，缓存须能容纳最大的udp数据报(65507字节)，避免被截断
+static constexpr size_t kMMsgCount = 16;
+static constexpr size_t kMMsgSize = kUdpRecvSize + 1;
+//开启GRO时recvmmsg一次最多读取的次数，每次最多读取64KB合并后的数据报
+static constexpr size_t kGroCount = 8;
+static constexpr size_t kGroSize = 64 * 1024 + 1;
+
+//文件区间经管道或者内存中转时每次读取的大小(管道默认容量)
+static constexpr size_t kFileChunkSize = 64 * 1024;
+//sendfile单次最大长度
+static constexpr size_t kMaxSendfileSize = 0x7ffff000;
+
+
+BufferFile::Ptr BufferFile::create(const string &path, uint64_t offset, uint64_t size) {
+#if defined(_WIN32)
+    return nullptr;
+#else
+    int fd = open(path.data(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        WarnL << "Open file failed: " << path << ", " << get_uv_errmsg(false);
+        return nullptr;
+    }
+    struct stat st;
+    if (-1 == fstat(fd, &st)) {
+        close(fd);
+        return nullptr;
+    }
+    if (!size) {
+        // 发送至文件末尾
+        size = (uint64_t)st.st_size > offset ? st.st_size - offset : 0;
+    }
+    // 虚拟文件(例如procfs)长度为0，不检查区间
+    if (!size || (st.st_size && offset + size > (uint64_t)st.st_size)) {
+        WarnL << "Invalid file range: " << path << ", offset: " << offset << ", size: " << size;
+        close(fd);
+        return nullptr;
+    }
+    return Ptr(new BufferFile(fd, offset, size));
+#endif
+}
+
+BufferFile::BufferFile(int fd, uint64_t offset, size_t size) : _fd(fd), _offset(offset), _size(size) {
+#if defined(__linux__) || defined(__linux)
+    _mode = Mode_Sendfile;
+#else
+    _mode = Mode_Read;
+#endif
+}
+
+BufferFile::~BufferFile() {
+#if !defined(_WIN32)
+    if (_pipe[0] != -1) {
+        close(_pipe[0]);
+        close(_pipe[1]);
+    }
+    close(_fd);
+#endif
+}
+
+string BufferFile::toString() const {
+    string ret;
+#if !defined(_WIN32)
+    ret.resize(_size);
+    size_t total = 0;
+    while (total < _size) {
+        auto n = pread(_fd, &ret[total], _size - total, _offset + total);
+        if (n <= 0) {
+            break;
+        }
+        total += n;
+    }
+    ret.resize(total);
+#endif
+    return ret;
+}
+
+void BufferFile::setOnComplete(onComplete cb) {
+    _on_complete = std::move(cb);
+}
+
+void BufferFile::complete() {
+    if (!_on_complete) {
+        return;
+    }
+    // 只回调一次
+    auto cb = std::move(_on_complete);
+    _on_complete = nullptr;
+    cb(_sent);
+}
+
+ssize_t BufferFile::send(int sock, size_t offset, int flags) {
+#if defined(_WIN32)
+    return -1;
+#else
+    ssize_t n;
+#if defined(__linux__) || defined(__linux)
+    if (_mode == Mode_Sendfile) {
+        off_t pos = _offset + offset;
+        do {
+            n = sendfile(sock, _fd, &pos, (std::min)(_size - offset, kMaxSendfileSize));
+        } while (-1 == n && UV_EINTR == get_uv_error(true));
+        if (n == -1 && (errno == EINVAL || errno == ENOSYS)) {
+            // 该文件不支持sendfile，改为经管道splice
+            _mode = Mode_Splice;
+        } else {
+            if (n == 0) {
+                // 文件被截断
+                errno = EIO;
+                return -1;
+            }
+            if (n > 0) {
+                _sent = offset + n;
+            }
+            return n;
+        }
+    }
+#endif
+    n = sendStaged(sock, offset, flags);
+    if (n > 0) {
+        _sent = offset + n;
+    }
+    return n;
+#endif
+}
+
+ssize_t BufferFile::sendStaged(int sock, size_t offset, int flags) {
+#if defined(_WIN32)
+    return -1;
+#else
+    if (!_staged) {
+        // 中转的数据已全部写入socket，读取下一块；文件读取位置为已写入socket的位置
+        auto n = fill(_offset + offset, (std::min)(_size - offset, kFileChunkSize));
+        if (n == 0) {
+            WarnL << "File is shorter than expected, fd: " << _fd;
+            errno = EIO;
+            return -1;
+        }
+        if (n == -1) {
+            return -1;
+        }
+        _staged = n;
+    }
+    auto n = drain(sock, flags);
+    if (n > 0) {
+        _staged -= n;
+    }
+    return n;
+#endif
+}
+
+ssize_t BufferFile::fill(uint64_t pos, size_t len) {
+    ssize_t n = -1;
+#if defined(__linux__) || defined(__linux)
+    if (_mode == Mode_Splice) {
+        if (_pipe[0] == -1 && -1 == pipe2(_pipe, O_NONBLOCK | O_CLOEXEC)) {
+            return -1;
+        }
+        loff_t off = pos;
+        do {
+            n = splice(_fd, &off, _pipe[1], nullptr, len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        } while (-1 == n && UV_EINTR == get_uv_error(true));
+        if (n != -1 || errno != EINVAL) {
+            return n;
+        }
+        // 该文件也不支持splice(例如procfs)，改为读取至内存后发送；此时管道为空，可直接切换
+        _mode = Mode_Read;
+    }
+#endif
+#if !defined(_WIN32)
+    _chunk.resize(kFileChunkSize);
+    do {
+        n = pread(_fd, &_chunk[0], len, pos);
+    } while (-1 == n && UV_EINTR == get_uv_error(true));
+    _chunk.resize(n > 0 ? n : 0);
+#endif
+    return n;
+}
+
+ssize_t BufferFile::drain(int sock, int flags) {
+    ssize_t n = -1;
+#if defined(__linux__) || defined(__linux)
+    if (_mode == Mode_Splice) {
+        do {
+            n = splice(_pipe[0], nullptr, sock, nullptr, _staged, SPLICE_F_MOVE | SPLICE_F_NONBLOCK | SPLICE_F_MORE);
+        } while (-1 == n && UV_EINTR == get_uv_error(true));
+        return n;
+    }
+#endif
+#if !defined(_WIN32)
+    // 尚未写入socket的是_chunk末尾的_staged字节
+    do {
+        n = ::send(sock, _chunk.data() + _chunk.size() - _staged, _staged, flags);
+    } while (-1 == n && UV_EINTR == get_uv_error(true));
+#endif
+    return n;
+}
+
+BufferSock::BufferSock(Buffer::Ptr buffer, const struct sockaddr *addr, socklen_t addr_len) {
+    if (addr) {
+        _addr_len = addr_len ? addr_len : SockUtil::get_sock_len(addr);
+        memcpy(&_addr, addr, _addr_len);
+    }
+    _buffer = std::move(buffer);
+}
+
+BufferList::Ptr BufferList::create(bool is_udp) {
+    if (is_udp) {
+#if defined(__linux__) || defined(__linux)
+        return std::make_shared<BufferSendMMsg>();
+#else
+        return std::make_shared<BufferSendTo>();
+#endif
+    }
+    return std::make_shared<BufferSendMsg>();
+}
+
+void BufferList::append(Buffer::Ptr buf) {
+    _remain_size += buf->size();
+    _pkt_list.emplace_back(std::move(buf));
+}
+
+void BufferList::appendFile(BufferFile::Ptr file) {
+    ++_file_count;
+    append(std::move(file));
+}
+
+bool BufferList::empty() const {
+    return _pkt_list.empty();
+}
+
+size_t BufferList::count() const {
+    return _pkt_list.size();
+}
+
+size_t BufferList::size() const {
+    return _remain_size;
+}
+
+BufferList::~BufferList() {
+    completeFiles();
+}
+
+void BufferList::completeFiles() {
+    if (!_file_count) {
+        return;
+    }
+    for (auto &buf : _pkt_list) {
+        if (auto file = dynamic_cast<BufferFile *>(buf.get())) {
+            // 未发送完毕即被丢弃
+            file->complete();
+        }
+    }
+}
+
+void BufferList::clear() {
+    completeFiles();
+    _pkt_list.clear();
+    _file_count = 0;
+    _offset = 0;
+    _remain_size = 0;
+}
+
+void BufferList::reOffset(size_t n) {
+    _remain_size -= n;
+    while (n) {
+        auto &front = _pkt_list.front();
+        auto left = front->size() - _offset;
+        if (n < left) {
+            // 部分发送
+            _offset += n;
+            return;
+        }
+        // 该Buffer已全部发送，释放之
+        n -= left;
+        _offset = 0;
+        popFront();
+    }
+}
+
+void BufferList::popFront() {
+    if (auto file = frontFile()) {
+        --_file_count;
+        file->complete();
+    }
+    _pkt_list.pop_front();
+}
+
+BufferFile *BufferList::frontFile() const {
+    return _file_count ? dynamic_cast<BufferFile *>(_pkt_list.front().get()) : nullptr;
+}
+
+bool BufferList::isFile(const Buffer::Ptr &buf) const {
+    return _file_count && dynamic_cast<BufferFile *>(buf.get());
+}
+
+ssize_t BufferSendMsg::send_l(int fd, int flags) {
+    if (auto file = frontFile()) {
+        return file->send(fd, _offset, flags);
+    }
+    auto count = (std::min)(_pkt_list.size(), (size_t)IOV_MAX);
+    _iovec.resize(count);
+    auto it = _pkt_list.begin();
+    for (size_t i = 0; i < count; ++i, ++it) {
+        if (isFile(*it)) {
+            // 文件区间之前的Buffer先发送
+            count = i;
+            break;
+        }
+        auto offset = i ? 0 : _offset;
+        _iovec[i].iov_base = (*it)->data() + offset;
+        _iovec[i].iov_len = (*it)->size() - offset;
+    }
+
+    ssize_t n;
+#if !defined(_WIN32)
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = _iovec.data();
+    msg.msg_iovlen = count;
+    do {
+        n = sendmsg(fd, &msg, flags);
+    } while (-1 == n && UV_EINTR == get_uv_error(true));
+#else
+    do {
+        n = ::send(fd, (char *)_iovec[0].iov_base, (int)_iovec[0].iov_len, flags);
+    } while (-1 == n && UV_EINTR == get_uv_error(true));
+#endif
+    return n;
+}
+
+ssize_t BufferSendMsg::send(int fd, int flags) {
+    ssize_t total = 0;
+    while (!_pkt_list.empty()) {
+        auto n = send_l(fd, flags);
+        if (n <= 0) {
+            return total ? total : -1;
+        }
+        total += n;
+        reOffset(n);
+    }
+    return total;
+}
+
+#if defined(__linux__) || defined(__linux)
+BufferSendMsgZeroCopy::BufferSendMsgZeroCopy(size_t min_size) : _min_size(min_size) {}
+
+ssize_t BufferSendMsgZeroCopy::send(int fd, int flags) {
+    ssize_t total = 0;
+    while (!_pkt_list.empty()) {
+        // 零拷贝需锁定内存页并等待完成通知，数据较少时拷贝更划算；文件区间由sendfile发送
+        bool zerocopy = _remain_size >= _min_size && !frontFile();
+        ssize_t n = -1;
+        if (zerocopy) {
+            n = send_l(fd, flags | MSG_ZEROCOPY);
+            if (n == -1 && get_uv_error(true) == UV_ENOBUFS) {
+                // 锁定内存超出optmem限制，本次退化为拷贝发送
+                zerocopy = false;
+            }
+        }
+        if (!zerocopy) {
+            n = send_l(fd, flags);
+        }
+        if (n <= 0) {
+            return total ? total : -1;
+        }
+        total += n;
+        if (zerocopy) {
+            // 每次成功的零拷贝发送占用一个序号
+            _pinned.emplace_back(Pinned { _next_seq++, false, {} });
+        }
+        pinSent(n, zerocopy);
+    }
+    return total;
+}
+
+void BufferSendMsgZeroCopy::pinSent(size_t n, bool zerocopy) {
+    _remain_size -= n;
+    while (n) {
+        auto &front = _pkt_list.front();
+        auto left = front->size() - _offset;
+        if (n < left) {
+            // 部分发送
+            _offset += n;
+            _front_pinned = _front_pinned || zerocopy;
+            return;
+        }
+        n -= left;
+        _offset = 0;
+        if ((zerocopy || _front_pinned) && !_pinned.empty()) {
+            // 内核仍引用该Buffer，挂在最近一次零拷贝发送上，确认后才释放
+            _pinned.back().buffers.emplace_back(front);
+            ++_pinned_count;
+        }
+        _front_pinned = false;
+        popFront();
+    }
+}
+
+size_t BufferSendMsgZeroCopy::recvCompletion(int fd) {
+    size_t count = 0;
+    while (true) {
+        union {
+            char buf[CMSG_SPACE(sizeof(struct sock_extended_err) + sizeof(struct sockaddr_in6))];
+            struct cmsghdr align;
+        } control;
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+
+        int ret;
+        do {
+            ret = recvmsg(fd, &msg, MSG_ERRQUEUE);
+        } while (-1 == ret && UV_EINTR == get_uv_error(true));
+        if (ret == -1) {
+            // 错误队列已读空
+            break;
+        }
+
+        for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (!((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR)
+                  || (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR))) {
+                continue;
+            }
+            struct sock_extended_err err;
+            memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+            if (err.ee_errno != 0 || err.ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                continue;
+            }
+            // 通知中为已完成发送的序号区间[ee_info, ee_data]
+            onComplete(err.ee_info, err.ee_data, err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED);
+            ++count;
+        }
+    }
+    return count;
+}
+
+void BufferSendMsgZeroCopy::onComplete(uint32_t lo, uint32_t hi, bool copied) {
+    if (copied && !_copied_logged) {
+        // 例如回环网卡或网卡不支持分散聚集，内核仍进行了拷贝
+        _copied_logged = true;
+        DebugL << "MSG_ZEROCOPY fell back to copy";
+    }
+    bool matched = false;
+    for (auto &pinned : _pinned) {
+        // 序号可能回绕
+        if ((uint32_t)(pinned.seq - lo) <= (uint32_t)(hi - lo)) {
+            pinned.done = true;
+            matched = true;
+        } else if (matched) {
+            break;
+        }
+    }
+    // 只有之前的发送均已确认时才释放，跨多次发送的Buffer挂在最后一次发送上
+    while (!_pinned.empty() && _pinned.front().done) {
+        _pinned_count -= _pinned.front().buffers.size();
+        _pinned.pop_front();
+    }
+}
+
+size_t BufferSendMsgZeroCopy::pinnedCount() const {
+    return _pinned_count;
+}
+#endif
+
+ssize_t BufferSendTo::send(int fd, int flags) {
+    ssize_t total = 0;
+    while (!_pkt_list.empty()) {
+        auto front = static_cast<BufferSock *>(_pkt_list.front().get());
+        ssize_t n;
+        do {
+            n = ::sendto(fd, front->data(), front->size(), flags, front->sockaddr(), front->sockaddr_len());
+        } while (-1 == n && UV_EINTR == get_uv_error(true));
+
+        if (n == -1 && get_uv_error(true) == UV_EAGAIN) {
+            // 内核缓存已满
+            return total ? total : -1;
+        }
+        // 发送成功或者出错都移除该数据报
+        total += front->size();
+        reOffset(front->size());
+    }
+    return total;
+}
+
+#if defined(__linux__) || defined(__linux)
+ssize_t BufferSendMMsg::send_l(int fd, int flags) {
+    auto count = (std::min)(_pkt_list.size(), (size_t)IOV_MAX);
+    _iovec.resize(count);
+    _hdrvec.resize(count);
+    auto it = _pkt_list.begin();
+    for (size_t i = 0; i < count; ++i, ++it) {
+        auto buffer = static_cast<BufferSock *>(it->get());
+        _iovec[i].iov_base = buffer->data();
+        _iovec[i].iov_len = buffer->size();
+        auto &hdr = _hdrvec[i].msg_hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.msg_name = (void *)buffer->sockaddr();
+        hdr.msg_namelen = buffer->sockaddr_len();
+        hdr.msg_iov = &_iovec[i];
+        hdr.msg_iovlen = 1;
+    }
+
+    int n;
+    do {
+        n = sendmmsg(fd, _hdrvec.data(), count, flags);
+    } while (-1 == n && UV_EINTR == get_uv_error(true));
+    return n;
+}
+
+ssize_t BufferSendMMsg::send(int fd, int flags) {
+    ssize_t total = 0;
+    while (!_pkt_list.empty()) {
+        auto n = send_l(fd, flags);
+        if (n == -1) {
+            if (get_uv_error(true) == UV_EAGAIN) {
+                // 内核缓存已满
+                return total ? total : -1;
+            }
+            // 首个数据报发送出错，丢弃之
+            n = 1;
+        }
+        for (ssize_t i = 0; i < n; ++i) {
+            auto size = _pkt_list.front()->size();
+            total += size;
+            reOffset(size);
+        }
+    }
+    return total;
+}
+#endif
+
+/**
+ * 每次读取一个数据包
+ */
+class SocketRecvFromBuffer : public SocketRecvBuffer {
+public:
+    SocketRecvFromBuffer(size_t size, bool is_udp) : _is_udp(is_udp), _size(size) {}
+
+    ssize_t recvFromSocket(int fd, ssize_t &count) override {
+        if (!_buffer || _buffer.use_count() > 1) {
+            // 上次交出的Buffer仍被持有，重新分配一个
+            auto raw = BufferRaw::create(_size);
+            _raw = raw.get();
+            _buffer = std::move(raw);
+        }
+        ssize_t nread;
+        do {
+            _addr_len = sizeof(_address);
+            nread = recvfrom(fd, _raw->data(), _size - 1, 0, (struct sockaddr *)&_address, &_addr_len);
+        } while (-1 == nread && UV_EINTR == get_uv_error(true));
+
+        if (nread >= 0) {
+            _raw->data()[nread] = '\0';
+            _raw->setSize(nread);
+        }
+        // udp无法通过读取长度判断是否还有数据报
+        _drained = nread < 0 || (!_is_udp && nread < (ssize_t)_size - 1);
+        count = nread >= 0 ? 1 : 0;
+        return nread;
+    }
+
+    Buffer::Ptr &getBuffer(size_t index) override {
+        return _buffer;
+    }
+
+    struct sockaddr *getAddress(size_t index, socklen_t &len) override {
+        len = _addr_len;
+        return (struct sockaddr *)&_address;
+    }
+
+    bool drained() const override {
+        return _drained;
+    }
+
+private:
+    bool _is_udp;
+    size_t _size;
+    bool _drained = true;
+    socklen_t _addr_len = 0;
+    struct sockaddr_storage _address;
+    BufferRaw *_raw = nullptr;
+    Buffer::Ptr _buffer;
+};
+
+#if defined(__linux__) || defined(__linux)
+/**
+ * 通过recvmmsg一次读取多个数据报
+ * 开启GRO时每次读取可能是多个合并的数据报，按cmsg中的分段大小拆分为引用读缓存的Buffer视图
+ */
+class SocketRecvmmsgBuffer : public SocketRecvBuffer {
+public:
+    SocketRecvmmsgBuffer(size_t count, size_t size, bool gro = false)
+        : _gro(gro), _size(size), _last_count(count), _mmsgs(count), _iovec(count), _address(count), _raws(count), _buffers(count) {
+        if (_gro) {
+            _control.resize(count);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            auto &hdr = _mmsgs[i].msg_hdr;
+            memset(&hdr, 0, sizeof(hdr));
+            hdr.msg_name = &_address[i];
+            hdr.msg_iov = &_iovec[i];
+            hdr.msg_iovlen = 1;
+        }
+    }
+
+    ssize_t recvFromSocket(int fd, ssize_t &count) override {
+        // 先释放上次拆分的视图，以免误判读缓存仍被使用者持有
+        _packets.clear();
+        _packet_slot.clear();
+        // 只有上次使用过的位置需要重新准备
+        for (size_t i = 0; i < _last_count; ++i) {
+            auto &buffer = _buffers[i];
+            if (!buffer || buffer.use_count() > 1) {
+                auto raw = BufferRaw::create(_size);
+                _raws[i] = raw.get();
+                buffer = std::move(raw);
+            }
+            _iovec[i].iov_base = _raws[i]->data();
+            _iovec[i].iov_len = _size - 1;
+            auto &hdr = _mmsgs[i].msg_hdr;
+            hdr.msg_namelen = sizeof(struct sockaddr_storage);
+            hdr.msg_flags = 0;
+            if (_gro) {
+                hdr.msg_control = _control[i].buf;
+                hdr.msg_controllen = sizeof(_control[i].buf);
+            }
+        }
+
+        int n;
+        do {
+            n = recvmmsg(fd, _mmsgs.data(), _mmsgs.size(), 0, nullptr);
+        } while (-1 == n && UV_EINTR == get_uv_error(true));
+
+        _last_count = n > 0 ? n : 0;
+        count = _last_count;
+        if (n <= 0) {
+            return n;
+        }
+
+        ssize_t total = 0;
+        for (int i = 0; i < n; ++i) {
+            auto len = _mmsgs[i].msg_len;
+            if (_mmsgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                WarnL << "Udp packet truncated, buffer size: " << _size - 1;
+            }
+            _raws[i]->data()[len] = '\0';
+            _raws[i]->setSize(len);
+            total += len;
+            if (_gro) {
+                splitSegments(i, len);
+            }
+        }
+        if (_gro) {
+            count = _packets.size();
+        }
+        return total;
+    }
+
+    Buffer::Ptr &getBuffer(size_t index) override {
+        return _gro ? _packets[index] : _buffers[index];
+    }
+
+    struct sockaddr *getAddress(size_t index, socklen_t &len) override {
+        if (_gro) {
+            index = _packet_slot[index];
+        }
+        len = _mmsgs[index].msg_hdr.msg_namelen;
+        return (struct sockaddr *)&_address[index];
+    }
+
+    bool drained() const override {
+        return _last_count < _mmsgs.size();
+    }
+
+private:
+    /**
+     * 按UDP_GRO cmsg中的分段大小拆分第slot次读取的数据
+     */
+    void splitSegments(size_t slot, size_t len) {
+        size_t segment = 0;
+        auto &hdr = _mmsgs[slot].msg_hdr;
+        for (auto cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+            if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+                int gso_size;
+                memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+                segment = gso_size > 0 ? gso_size : 0;
+                break;
+            }
+        }
+        if (!segment || len <= segment) {
+            // 未合并
+            _packets.emplace_back(_buffers[slot]);
+            _packet_slot.emplace_back(slot);
+            return;
+        }
+        for (size_t offset = 0; offset < len; offset += segment) {
+            _packets.emplace_back(std::make_shared<BufferOffset>(_buffers[slot], offset, segment));
+            _packet_slot.emplace_back(slot);
+        }
+    }
+
+private:
+    // 保证cmsghdr对齐
+    union GroControl {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    };
+
+    bool _gro;
+    size_t _size;
+    size_t _last_count;
+    std::vector<struct mmsghdr> _mmsgs;
+    std::vector<struct iovec> _iovec;
+    std::vector<struct sockaddr_storage> _address;
+    std::vector<BufferRaw *> _raws;
+    std::vector<Buffer::Ptr> _buffers;
+    std::vector<GroControl> _control;
+    // 开启GRO时拆分后的数据报及其所在的读取位置
+    std::vector<Buffer::Ptr> _packets;
+    std::vector<size_t> _packet_slot;
+};
+#endif
+
+SocketRecvBuffer::Ptr SocketRecvBuffer::create(bool is_udp, bool gro) {
+    if (!is_udp) {
+        return std::make_shared<SocketRecvFromBuffer>(kTcpRecvSize, false);
+    }
+#if defined(__linux__) || defined(__linux)
+    if (gro) {
+        return std::make_shared<SocketRecvmmsgBuffer>(kGroCount, kGroSize, true);
+    }
+    return std::make_shared<SocketRecvmmsgBuffer>(kMMsgCount, kMMsgSize);
+#else
+    return std::make_shared<SocketRecvFromBuffer>(kUdpRecvSize, true);
+#endif
+}
+
+} // namespace FFZKit
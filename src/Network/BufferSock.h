@@ -0,0 +1,373 @@
+//
+// Created by FFZero on 2025-05-24.
+//
+
+#ifndef FFZKIT_BUFFERSOCK_H
+#define FFZKIT_BUFFERSOCK_H
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include "Util/List.h"
+#include "Util/util.h"
+#include "Network/Buffer.h"
+#include "Network/sockutil.h"
+
+#if !defined(_WIN32)
+#include <sys/uio.h>
+#include <climits>
+#endif
+
+namespace FFZKit {
+
+#if !defined(IOV_MAX)
+#define IOV_MAX 1024
+#endif
+
+#if defined(_WIN32)
+struct iovec {
+    void *iov_base;
+    size_t iov_len;
+};
+#endif
+
+/**
+ * 带目标地址的Buffer，用于udp发送缓存
+ */
+class BufferSock : public Buffer {
+public:
+    using Ptr = std::shared_ptr<BufferSock>;
+
+    /**
+     * @param buffer 数据
+     * @param addr 目标地址，为空时发送至已绑定的目标地址
+     * @param addr_len 目标地址长度，为0时自动获取
+     */
+    BufferSock(Buffer::Ptr buffer, const struct sockaddr *addr = nullptr, socklen_t addr_len = 0);
+
+    char *data() const override {
+        return _buffer->data();
+    }
+
+    size_t size() const override {
+        return _buffer->size();
+    }
+
+    const struct sockaddr *sockaddr() const {
+        return _addr_len ? (const struct sockaddr *)&_addr : nullptr;
+    }
+
+    socklen_t sockaddr_len() const {
+        return _addr_len;
+    }
+
+private:
+    socklen_t _addr_len = 0;
+    struct sockaddr_storage _addr;
+    Buffer::Ptr _buffer;
+};
+
+/**
+ * 文件区间，作为tcp发送缓存中的一项与其他Buffer按顺序发送，文件内容不读入内存
+ * linux下使用sendfile由内核直接发送，文件不支持sendfile时经管道splice，仍不支持时(例如procfs)分块读取后发送；
+ * 其他系统分块读取后发送
+ * data()为空，toString()会从文件读取
+ */
+class BufferFile : public Buffer {
+public:
+    using Ptr = std::shared_ptr<BufferFile>;
+    //发送结束(发送完毕或者被丢弃)回调，参数为已写入socket的字节数，等于size()代表发送完毕
+    using onComplete = std::function<void(uint64_t sent)>;
+
+    /**
+     * 打开文件区间
+     * @param path 文件路径
+     * @param offset 起始偏移
+     * @param size 长度，0为到文件末尾
+     * @return 打开失败或者区间越界时返回空
+     */
+    static Ptr create(const std::string &path, uint64_t offset = 0, uint64_t size = 0);
+    ~BufferFile() override;
+
+    char *data() const override {
+        return nullptr;
+    }
+
+    size_t size() const override {
+        return _size;
+    }
+
+    std::string toString() const override;
+
+    void setOnComplete(onComplete cb);
+
+    /**
+     * 发送结束(发送完毕或者被发送缓存丢弃)时由发送缓存调用，只回调一次
+     */
+    void complete();
+
+    /**
+     * 写入socket，每次调用最多一次写系统调用
+     * @param sock socket fd
+     * @param offset 区间内已写入socket的字节数
+     * @param flags send flags，仅分块读取模式有效
+     * @return 本次写入的字节数，-1为失败，失败原因通过get_uv_error获取
+     */
+    ssize_t send(int sock, size_t offset, int flags);
+
+private:
+    BufferFile(int fd, uint64_t offset, size_t size);
+
+    ssize_t sendStaged(int sock, size_t offset, int flags);
+    ssize_t fill(uint64_t pos, size_t len);
+    ssize_t drain(int sock, int flags);
+
+private:
+    enum Mode { Mode_Sendfile, Mode_Splice, Mode_Read };
+
+    int _fd;
+    Mode _mode;
+    uint64_t _offset;
+    size_t _size;
+    uint64_t _sent = 0;
+    // 已从文件读出、尚未写入socket的字节数(位于管道或者_chunk中)
+    size_t _staged = 0;
+    int _pipe[2] = { -1, -1 };
+    std::string _chunk;
+    onComplete _on_complete;
+};
+
+/**
+ * socket发送缓存，按顺序保存待发送的Buffer
+ * 每次发送尽量合并多个Buffer为一次系统调用，已完全发送的Buffer立即释放(回到各自的ResourcePool)
+ */
+class BufferList : public noncopyable {
+public:
+    using Ptr = std::shared_ptr<BufferList>;
+
+    virtual ~BufferList();
+
+    /**
+     * 创建发送缓存
+     * @param is_udp 是否为udp，udp每个Buffer为一个独立的数据报，且必须为BufferSock
+     */
+    static Ptr create(bool is_udp = false);
+
+    /**
+     * 追加待发送的数据
+     */
+    void append(Buffer::Ptr buf);
+
+    /**
+     * 追加待发送的文件区间，仅tcp发送缓存支持
+     */
+    void appendFile(BufferFile::Ptr file);
+
+    /**
+     * 是否已全部发送
+     */
+    bool empty() const;
+
+    /**
+     * 剩余Buffer个数
+     */
+    size_t count() const;
+
+    /**
+     * 剩余未发送的字节数
+     */
+    size_t size() const;
+
+    /**
+     * 丢弃所有未发送的数据
+     */
+    void clear();
+
+    /**
+     * 发送数据，直到全部发送完毕或者发送失败(包括内核缓存已满)
+     * @param fd socket fd
+     * @param flags send flags
+     * @return 本次发送的字节数；未发送任何数据且失败时返回-1，失败原因通过get_uv_error获取
+     */
+    virtual ssize_t send(int fd, int flags) = 0;
+
+protected:
+    BufferList() = default;
+
+    /**
+     * 已发送n个字节，释放已完全发送的Buffer
+     */
+    void reOffset(size_t n);
+
+    /**
+     * 移除首个Buffer
+     */
+    void popFront();
+
+    /**
+     * 首个Buffer为文件区间时返回之
+     */
+    BufferFile *frontFile() const;
+
+    /**
+     * 该Buffer是否为文件区间
+     */
+    bool isFile(const Buffer::Ptr &buf) const;
+
+    /**
+     * 回调缓存中所有文件区间的发送结束事件
+     */
+    void completeFiles();
+
+protected:
+    // 首个Buffer已发送的字节数
+    size_t _offset = 0;
+    size_t _remain_size = 0;
+    // 缓存中文件区间的个数，为0时无需逐个判断Buffer类型
+    size_t _file_count = 0;
+    List<Buffer::Ptr> _pkt_list;
+};
+
+/**
+ * tcp发送缓存，一次writev/sendmsg发送最多IOV_MAX个Buffer，文件区间单独发送
+ */
+class BufferSendMsg : public BufferList {
+public:
+    ssize_t send(int fd, int flags) override;
+
+protected:
+    ssize_t send_l(int fd, int flags);
+
+private:
+    // 复用的iovec数组
+    std::vector<struct iovec> _iovec;
+};
+
+#if defined(__linux__) || defined(__linux)
+/**
+ * tcp零拷贝发送缓存(MSG_ZEROCOPY)，socket需先开启SO_ZEROCOPY
+ * 内核直接引用Buffer所在内存，已发送的Buffer在收到错误队列中的完成通知前不会释放，
+ * 通知到达后按发送顺序释放(回到各自的ResourcePool)；待发送数据较少时仍使用普通拷贝发送
+ * socket关闭时若仍有未确认的Buffer，由Socket继续持有该缓存直到完成通知到达(超时则重置连接)，见Socket::closeSock
+ */
+class BufferSendMsgZeroCopy : public BufferSendMsg {
+public:
+    /**
+     * @param min_size 待发送数据不小于该值时才使用零拷贝发送
+     */
+    BufferSendMsgZeroCopy(size_t min_size);
+
+    ssize_t send(int fd, int flags) override;
+
+    /**
+     * 读取socket错误队列中的零拷贝完成通知，释放已确认的Buffer
+     * @param fd socket fd
+     * @return 读取到的通知个数
+     */
+    size_t recvCompletion(int fd);
+
+    /**
+     * 已发送但未确认、仍被锁定的Buffer个数
+     */
+    size_t pinnedCount() const;
+
+private:
+    /**
+     * 已发送n个字节，已完全发送的Buffer移入锁定列表
+     * @param zerocopy 本次是否为零拷贝发送
+     */
+    void pinSent(size_t n, bool zerocopy);
+    void onComplete(uint32_t lo, uint32_t hi, bool copied);
+
+private:
+    // 一次零拷贝发送及其完全发送的Buffer
+    struct Pinned {
+        uint32_t seq;
+        bool done;
+        std::vector<Buffer::Ptr> buffers;
+    };
+
+    size_t _min_size;
+    size_t _pinned_count = 0;
+    // 下一次零拷贝发送的序号，与内核计数一致
+    uint32_t _next_seq = 0;
+    // 首个Buffer是否已有部分数据以零拷贝方式发送
+    bool _front_pinned = false;
+    bool _copied_logged = false;
+    List<Pinned> _pinned;
+};
+#endif
+
+/**
+ * udp发送缓存，每个BufferSock单独发送至各自的目标地址，发送出错(非内核缓存已满)的数据报直接丢弃
+ */
+class BufferSendTo : public BufferList {
+public:
+    ssize_t send(int fd, int flags) override;
+};
+
+#if defined(__linux__) || defined(__linux)
+/**
+ * udp发送缓存，一次sendmmsg发送多个数据报(可发往不同目标地址)，发送出错的数据报直接丢弃
+ */
+class BufferSendMMsg : public BufferList {
+public:
+    ssize_t send(int fd, int flags) override;
+
+private:
+    ssize_t send_l(int fd, int flags);
+
+private:
+    std::vector<struct iovec> _iovec;
+    std::vector<struct mmsghdr> _hdrvec;
+};
+#endif
+
+/**
+ * socket接收缓存，从socket读取一个或多个数据包
+ * 交出的Buffer在回调之后仍可继续持有，此时下次读取前会为该位置重新分配Buffer
+ */
+class SocketRecvBuffer : public noncopyable {
+public:
+    using Ptr = std::shared_ptr<SocketRecvBuffer>;
+
+    virtual ~SocketRecvBuffer() = default;
+
+    /**
+     * 创建接收缓存
+     * @param is_udp 是否为udp；linux下udp使用recvmmsg一次读取多个数据报
+     * @param gro 是否为开启了UDP_GRO的udp(仅linux)，合并读取的数据报按分段大小拆分为多个Buffer视图
+     */
+    static Ptr create(bool is_udp, bool gro = false);
+
+    /**
+     * 从socket读取数据
+     * @param fd socket fd
+     * @param count 读取到的数据包个数
+     * @return 读取到的总字节数，tcp返回0代表对端关闭；-1为失败，失败原因通过get_uv_error获取
+     */
+    virtual ssize_t recvFromSocket(int fd, ssize_t &count) = 0;
+
+    /**
+     * 获取第index个数据包
+     */
+    virtual Buffer::Ptr &getBuffer(size_t index) = 0;
+
+    /**
+     * 获取第index个数据包的来源地址
+     * @param len 地址长度，tcp为0
+     */
+    virtual struct sockaddr *getAddress(size_t index, socklen_t &len) = 0;
+
+    /**
+     * 上次读取未读满缓存，说明内核缓存已读空
+     */
+    virtual bool drained() const = 0;
+
+protected:
+    SocketRecvBuffer() = default;
+};
+
+} // namespace FFZKit
+
+#endif //FFZKIT_BUFFERSOCK_H
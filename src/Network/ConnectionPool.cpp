@@ -0,0 +1,302 @@
+//
+// Created by FFZero on 2025-07-05.
+//
+
+#include "ConnectionPool.h"
+#include "Util/logger.h"
+#include "Util/uv_errno.h"
+
+using namespace std;
+
+namespace FFZKit {
+
+//时间轮每格的时长
+static constexpr uint64_t kTickMs = 1000;
+
+//复用前检查连接：对端已关闭(recv返回0)或者有未读数据(协议错乱)都不能复用
+static bool checkUsable(const Socket::Ptr &sock) {
+    if (!sock->alive() || sock->getSendBufferSize()) {
+        return false;
+    }
+    char buf;
+    auto ret = ::recv(sock->rawFD(), &buf, 1, MSG_PEEK);
+    return ret == -1 && get_uv_error(true) == UV_EAGAIN;
+}
+
+ConnectionPool::ConnectionPool(const EventPoller::Ptr &poller) : _poller(poller) {
+    resetWheel();
+}
+
+ConnectionPool::~ConnectionPool() {
+    if (_timer) {
+        _timer->cancel();
+    }
+}
+
+const EventPoller::Ptr &ConnectionPool::getPoller() const {
+    return _poller;
+}
+
+ConnectionPool::Statistic ConnectionPool::getStatistic() const {
+    Statistic ret;
+    ret.created = _created.load();
+    ret.reused = _reused.load();
+    ret.evicted = _evicted.load();
+    ret.invalid = _invalid.load();
+    ret.idle = _idle.load();
+    return ret;
+}
+
+void ConnectionPool::setMaxIdle(size_t count) {
+    weak_ptr<ConnectionPool> weak_self = shared_from_this();
+    _poller->async([weak_self, count]() {
+        if (auto strong_self = weak_self.lock()) {
+            strong_self->_max_idle = count;
+        }
+    });
+}
+
+void ConnectionPool::setIdleTimeout(uint32_t second) {
+    weak_ptr<ConnectionPool> weak_self = shared_from_this();
+    _poller->async([weak_self, second]() {
+        if (auto strong_self = weak_self.lock()) {
+            strong_self->_idle_timeout = second;
+            strong_self->resetWheel();
+        }
+    });
+}
+
+void ConnectionPool::setConnectTimeout(float second) {
+    weak_ptr<ConnectionPool> weak_self = shared_from_this();
+    _poller->async([weak_self, second]() {
+        if (auto strong_self = weak_self.lock()) {
+            strong_self->_connect_timeout = second;
+        }
+    });
+}
+
+void ConnectionPool::setMinIdle(const string &host, uint16_t port, size_t count, const string &local_ip) {
+    weak_ptr<ConnectionPool> weak_self = shared_from_this();
+    _poller->async([weak_self, host, port, count, local_ip]() {
+        if (auto strong_self = weak_self.lock()) {
+            string key;
+            auto &target = strong_self->getTarget(host, port, local_ip, key);
+            target.min_idle = count;
+            strong_self->maintain(key, target);
+        }
+    });
+}
+
+void ConnectionPool::get(const string &host, uint16_t port, onGetCB cb, const string &local_ip) {
+    weak_ptr<ConnectionPool> weak_self = shared_from_this();
+    _poller->async([weak_self, host, port, cb, local_ip]() {
+        auto strong_self = weak_self.lock();
+        if (!strong_self) {
+            cb(SockException(Err_shutdown, "connection pool destroyed"), nullptr);
+            return;
+        }
+        strong_self->get_l(host, port, cb, local_ip);
+    });
+}
+
+ConnectionPool::Target &ConnectionPool::getTarget(const string &host, uint16_t port, const string &local_ip, string &key) {
+    key = StrPrinter << host << ":" << port << "@" << local_ip;
+    auto &target = _targets[key];
+    if (target.host.empty()) {
+        target.host = host;
+        target.port = port;
+        target.local_ip = local_ip;
+    }
+    if (!_timer) {
+        startTimer();
+    }
+    return target;
+}
+
+void ConnectionPool::get_l(const string &host, uint16_t port, const onGetCB &cb, const string &local_ip) {
+    string key;
+    auto &target = getTarget(host, port, local_ip, key);
+    while (!target.idle.empty()) {
+        // 优先复用最近归还的连接
+        auto conn = std::move(target.idle.front());
+        target.idle.pop_front();
+        conn->idle = false;
+        --_idle;
+        if (!checkUsable(conn->sock)) {
+            ++_invalid;
+            continue;
+        }
+        ++_reused;
+        auto sock = std::move(conn->sock);
+        // 清除空闲期间的回调
+        sock->setOnRead(nullptr);
+        sock->setOnErr(nullptr);
+        cb(SockException(), wrap(key, sock));
+        maintain(key, target);
+        return;
+    }
+    connect_l(key, target, cb);
+}
+
+void ConnectionPool::connect_l(const string &key, Target &target, const onGetCB &cb) {
+    ++target.connecting;
+    ++_created;
+    weak_ptr<ConnectionPool> weak_self = shared_from_this();
+    auto sock = Socket::createSocket(_poller);
+    // 连接回调持有sock直到连接结束
+    sock->connect(target.host, target.port, [weak_self, sock, key, cb](const SockException &err) {
+        auto strong_self = weak_self.lock();
+        if (!strong_self) {
+            if (cb) {
+                cb(SockException(Err_shutdown, "connection pool destroyed"), nullptr);
+            }
+            return;
+        }
+        --strong_self->_targets[key].connecting;
+        if (err) {
+            WarnL << "Connect to " << key << " failed: " << err;
+            if (cb) {
+                cb(err, nullptr);
+            }
+            return;
+        }
+        if (cb) {
+            cb(err, strong_self->wrap(key, sock));
+        } else {
+            // 预连接，直接放入空闲列表
+            strong_self->recycle(key, sock);
+        }
+    }, _connect_timeout, target.local_ip);
+}
+
+Socket::Ptr ConnectionPool::wrap(const string &key, const Socket::Ptr &sock) {
+    weak_ptr<ConnectionPool> weak_self = shared_from_this();
+    auto poller = _poller;
+    // 最后一个引用释放时归还；总是异步归还，避免在该socket自身的回调中修改其回调
+    return Socket::Ptr(sock.get(), [weak_self, poller, key, sock](Socket *) {
+        poller->async([weak_self, key, sock]() {
+            if (auto strong_self = weak_self.lock()) {
+                strong_self->recycle(key, sock);
+            }
+        }, false);
+    });
+}
+
+void ConnectionPool::recycle(const string &key, const Socket::Ptr &sock) {
+    auto it = _targets.find(key);
+    if (it == _targets.end()) {
+        return;
+    }
+    auto &target = it->second;
+    if (!sock->alive() || sock->getSendBufferSize() || target.idle.size() >= _max_idle) {
+        // 不可复用，sock释放后关闭
+        return;
+    }
+
+    auto conn = std::make_shared<IdleConn>();
+    conn->sock = sock;
+    conn->key = key;
+    target.idle.emplace_front(conn);
+    conn->it = target.idle.begin();
+    ++_idle;
+
+    weak_ptr<ConnectionPool> weak_self = shared_from_this();
+    weak_ptr<IdleConn> weak_conn = conn;
+    sock->setOnFlush(nullptr);
+    sock->enableRecv(true);
+    sock->setOnRead([weak_self, weak_conn](Buffer::Ptr &buf, struct sockaddr *, int) {
+        auto strong_self = weak_self.lock();
+        auto strong_conn = weak_conn.lock();
+        if (strong_self && strong_conn && strong_conn->idle) {
+            WarnL << "Idle connection to " << strong_conn->key << " received " << buf->size() << " bytes, close it";
+            ++strong_self->_invalid;
+            strong_self->removeIdle(strong_conn);
+        }
+    });
+    sock->setOnErr([weak_self, weak_conn](const SockException &err) {
+        auto strong_self = weak_self.lock();
+        auto strong_conn = weak_conn.lock();
+        if (strong_self && strong_conn && strong_conn->idle) {
+            DebugL << "Idle connection to " << strong_conn->key << " closed: " << err;
+            ++strong_self->_invalid;
+            strong_self->removeIdle(strong_conn);
+        }
+    });
+    addToWheel(conn);
+}
+
+void ConnectionPool::removeIdle(const shared_ptr<IdleConn> &conn) {
+    if (!conn->idle) {
+        return;
+    }
+    conn->idle = false;
+    --_idle;
+    _targets[conn->key].idle.erase(conn->it);
+}
+
+void ConnectionPool::addToWheel(const shared_ptr<IdleConn> &conn) {
+    if (_wheel.empty()) {
+        return;
+    }
+    _wheel[(_cursor + _idle_timeout) % _wheel.size()].emplace_back(conn);
+}
+
+void ConnectionPool::resetWheel() {
+    _wheel.clear();
+    _wheel.resize(_idle_timeout ? _idle_timeout + 1 : 0);
+    _cursor = 0;
+    for (auto &pr : _targets) {
+        for (auto &conn : pr.second.idle) {
+            addToWheel(conn);
+        }
+    }
+}
+
+void ConnectionPool::startTimer() {
+    weak_ptr<ConnectionPool> weak_self = shared_from_this();
+    _timer = _poller->doDelayTask(kTickMs, [weak_self]() -> uint64_t {
+        auto strong_self = weak_self.lock();
+        if (!strong_self) {
+            return 0;
+        }
+        strong_self->onTick();
+        return kTickMs;
+    });
+}
+
+void ConnectionPool::onTick() {
+    if (!_wheel.empty()) {
+        _cursor = (_cursor + 1) % _wheel.size();
+        auto slot = std::move(_wheel[_cursor]);
+        _wheel[_cursor].clear();
+        for (auto &weak_conn : slot) {
+            // 已被复用或者移除的连接弱引用已失效
+            auto conn = weak_conn.lock();
+            if (!conn || !conn->idle) {
+                continue;
+            }
+            if (_targets[conn->key].idle.size() <= _targets[conn->key].min_idle) {
+                // 保留最少空闲连接，重新计时
+                addToWheel(conn);
+                continue;
+            }
+            ++_evicted;
+            removeIdle(conn);
+        }
+    }
+    // 补足预连接(包括之前连接失败的)
+    for (auto &pr : _targets) {
+        maintain(pr.first, pr.second);
+    }
+}
+
+void ConnectionPool::maintain(const string &key, Target &target) {
+    auto exists = target.idle.size() + target.connecting;
+    auto min_idle = (std::min)(target.min_idle, _max_idle);
+    // 先算出个数，连接可能同步失败并修改connecting
+    for (size_t i = exists; i < min_idle; ++i) {
+        connect_l(key, target, nullptr);
+    }
+}
+
+} // namespace FFZKit
@@ -0,0 +1,143 @@
+//
+// Created by FFZero on 2025-07-05.
+//
+
+#ifndef FFZKIT_CONNECTIONPOOL_H
+#define FFZKIT_CONNECTIONPOOL_H
+
+#include <list>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include "Network/Socket.h"
+
+namespace FFZKit {
+
+/**
+ * tcp客户端连接池，按(host, port, local_ip)缓存已建立的空闲连接，每个poller一个实例
+ * get获取的连接在最后一个引用释放后自动归还(类似ResourcePool::obtain2)，连接已断开、仍有未发送数据或者空闲连接已满时关闭；
+ * 不想复用的连接调用closeSock后再释放即可
+ * 使用者在连接上设置的回调不要强引用该连接，否则无法归还
+ * 复用前以MSG_PEEK检查连接是否已被对端关闭；空闲连接收到数据视为协议错乱，直接关闭
+ * 空闲超时由时间轮淘汰，但至少保留setMinIdle设置的个数，不足时自动预连接
+ * 所有状态只在poller线程访问，接口线程安全
+ */
+class ConnectionPool : public std::enable_shared_from_this<ConnectionPool>, public noncopyable {
+public:
+    using Ptr = std::shared_ptr<ConnectionPool>;
+    //获取结果回调，在poller线程执行；失败时sock为空
+    using onGetCB = std::function<void(const SockException &err, const Socket::Ptr &sock)>;
+
+    //连接池统计
+    struct Statistic {
+        //累计新建的连接数(包括预连接)
+        uint64_t created = 0;
+        //累计复用的连接数
+        uint64_t reused = 0;
+        //累计因空闲超时淘汰的连接数
+        uint64_t evicted = 0;
+        //累计因已断开、收到数据或者检查失败而丢弃的空闲连接数
+        uint64_t invalid = 0;
+        //当前空闲连接数
+        uint64_t idle = 0;
+    };
+
+    ConnectionPool(const EventPoller::Ptr &poller);
+    ~ConnectionPool();
+
+    /**
+     * 获取连接，有可用的空闲连接时复用，否则新建
+     * @param host 服务器ip或域名
+     * @param port 服务器端口
+     * @param cb 结果回调
+     * @param local_ip 绑定的本地网卡ip
+     */
+    void get(const std::string &host, uint16_t port, onGetCB cb, const std::string &local_ip = "::");
+
+    /**
+     * 设置最少空闲连接数并预连接，空闲超时淘汰不会低于该个数
+     */
+    void setMinIdle(const std::string &host, uint16_t port, size_t count, const std::string &local_ip = "::");
+
+    /**
+     * 设置每个目标最多缓存的空闲连接数，默认16
+     */
+    void setMaxIdle(size_t count);
+
+    /**
+     * 设置空闲超时秒数，默认60秒，0为不淘汰
+     */
+    void setIdleTimeout(uint32_t second);
+
+    /**
+     * 设置新建连接的超时秒数，默认5秒
+     */
+    void setConnectTimeout(float second);
+
+    /**
+     * 获取统计数据，线程安全
+     */
+    Statistic getStatistic() const;
+
+    const EventPoller::Ptr &getPoller() const;
+
+private:
+    struct IdleConn;
+    using IdleList = std::list<std::shared_ptr<IdleConn> >;
+
+    struct IdleConn {
+        Socket::Ptr sock;
+        std::string key;
+        //在所属IdleList中的位置，用于O(1)移除
+        IdleList::iterator it;
+        //是否仍在空闲列表中
+        bool idle = true;
+    };
+
+    struct Target {
+        std::string host;
+        uint16_t port = 0;
+        std::string local_ip;
+        //最近归还的在前
+        IdleList idle;
+        size_t connecting = 0;
+        size_t min_idle = 0;
+    };
+
+    Target &getTarget(const std::string &host, uint16_t port, const std::string &local_ip, std::string &key);
+    void get_l(const std::string &host, uint16_t port, const onGetCB &cb, const std::string &local_ip);
+    void connect_l(const std::string &key, Target &target, const onGetCB &cb);
+    Socket::Ptr wrap(const std::string &key, const Socket::Ptr &sock);
+    void recycle(const std::string &key, const Socket::Ptr &sock);
+    void removeIdle(const std::shared_ptr<IdleConn> &conn);
+    void addToWheel(const std::shared_ptr<IdleConn> &conn);
+    void resetWheel();
+    void startTimer();
+    void onTick();
+    void maintain(const std::string &key, Target &target);
+
+private:
+    EventPoller::Ptr _poller;
+    size_t _max_idle = 16;
+    uint32_t _idle_timeout = 60;
+    float _connect_timeout = 5;
+    std::unordered_map<std::string, Target> _targets;
+
+    //时间轮，每格一个tick，空闲连接放入超时对应的格子，连接被复用或移除后弱引用失效
+    std::vector<std::vector<std::weak_ptr<IdleConn> > > _wheel;
+    size_t _cursor = 0;
+    EventPoller::DelayTask::Ptr _timer;
+
+    std::atomic<uint64_t> _created { 0 };
+    std::atomic<uint64_t> _reused { 0 };
+    std::atomic<uint64_t> _evicted { 0 };
+    std::atomic<uint64_t> _invalid { 0 };
+    std::atomic<uint64_t> _idle { 0 };
+};
+
+} // namespace FFZKit
+
+#endif //FFZKIT_CONNECTIONPOOL_H
@@ -0,0 +1,92 @@
+//
+// Created by FFZero on 2025-07-05.
+//
+
+#include "DnsResolver.h"
+#include <cstring>
+#include "Util/logger.h"
+
+using namespace std;
+
+namespace FFZKit {
+
+static size_t s_worker_count = 4;
+
+DnsResolver &DnsResolver::Instance() {
+    static DnsResolver s_instance;
+    return s_instance;
+}
+
+void DnsResolver::setWorkerCount(size_t count) {
+    s_worker_count = count ? count : 1;
+}
+
+DnsResolver::DnsResolver() {
+    //解析线程多数时间阻塞在网络等待上，不设置优先级与cpu亲和性
+    _workers.reset(new ThreadPool((int)s_worker_count, ThreadPool::PRIORITY_NORMAL, true, false, "dns"));
+}
+
+size_t DnsResolver::pendingCount() {
+    lock_guard<mutex> lck(_mtx);
+    return _pending.size();
+}
+
+void DnsResolver::resolve(const string &host, uint16_t port, const EventPoller::Ptr &poller, onResolved cb,
+                          int ai_family, int ai_socktype, int ai_protocol) {
+    Waiter waiter { poller, port, std::move(cb) };
+    struct sockaddr_storage addr;
+    if (SockUtil::getDomainIPFromCache(host.data(), port, addr, ai_family, ai_socktype, ai_protocol)) {
+        //ip地址或者缓存命中时不经过线程池
+        deliver(waiter, SockException(), addr);
+        return;
+    }
+
+    string key = StrPrinter << host << '#' << ai_family << '#' << ai_socktype << '#' << ai_protocol;
+    {
+        lock_guard<mutex> lck(_mtx);
+        auto &waiters = _pending[key];
+        waiters.emplace_back(std::move(waiter));
+        if (waiters.size() > 1) {
+            //该域名已在解析中，等待其结果
+            return;
+        }
+    }
+
+    _workers->async([this, key, host, ai_family, ai_socktype, ai_protocol]() {
+        struct sockaddr_storage addr;
+        memset(&addr, 0, sizeof(addr));
+        auto ok = SockUtil::getDomainIP(host.data(), 0, addr, ai_family, ai_socktype, ai_protocol);
+        onDone(key, ok, addr);
+    });
+}
+
+void DnsResolver::onDone(const string &key, bool success, const struct sockaddr_storage &addr) {
+    vector<Waiter> waiters;
+    {
+        lock_guard<mutex> lck(_mtx);
+        auto it = _pending.find(key);
+        if (it == _pending.end()) {
+            return;
+        }
+        waiters.swap(it->second);
+        _pending.erase(it);
+    }
+    SockException err;
+    if (!success) {
+        err = SockException(Err_dns, "resolve domain failed: " + key.substr(0, key.find('#')));
+    }
+    for (auto &waiter : waiters) {
+        deliver(waiter, err, addr);
+    }
+}
+
+void DnsResolver::deliver(const Waiter &waiter, const SockException &err, const struct sockaddr_storage &addr) {
+    auto result = addr;
+    if (!err) {
+        SockUtil::set_sockaddr_port(result, waiter.port);
+    }
+    auto cb = waiter.cb;
+    waiter.poller->async([cb, err, result]() { cb(err, result); });
+}
+
+} // namespace FFZKit
@@ -0,0 +1,80 @@
+//
+// Created by FFZero on 2025-07-05.
+//
+
+#ifndef FFZKIT_DNSRESOLVER_H
+#define FFZKIT_DNSRESOLVER_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include "Network/sockutil.h"
+#include "Network/Socket.h"
+#include "Poller/EventPoller.h"
+#include "Thread/ThreadPool.h"
+
+namespace FFZKit {
+
+/**
+ * 异步dns解析，阻塞式的getaddrinfo在专用线程池中执行，结果切回发起请求的poller线程回调
+ * 同一域名同时只有一个解析在进行，期间的其他请求等待该结果
+ */
+class DnsResolver {
+public:
+    /**
+     * 解析结果回调，在请求指定的poller线程执行
+     * @param err 解析失败时为Err_dns
+     * @param addr 解析到的地址，端口已设置
+     */
+    using onResolved = std::function<void(const SockException &err, const struct sockaddr_storage &addr)>;
+
+    static DnsResolver &Instance();
+
+    /**
+     * 设置解析线程个数，在DnsResolver单例创建前有效
+     */
+    static void setWorkerCount(size_t count);
+
+    /**
+     * 异步解析域名，host为ip地址或者dns缓存命中时不经过线程池
+     * 在poller线程调用且不经过线程池时，回调可能同步执行
+     * @param host 域名或ip
+     * @param port 端口号
+     * @param poller 执行回调的poller
+     * @param cb 结果回调
+     * @param ai_family 优先的地址族
+     */
+    void resolve(const std::string &host, uint16_t port, const EventPoller::Ptr &poller, onResolved cb,
+                 int ai_family = AF_INET, int ai_socktype = SOCK_STREAM, int ai_protocol = IPPROTO_TCP);
+
+    /**
+     * 正在解析的域名个数
+     */
+    size_t pendingCount();
+
+private:
+    DnsResolver();
+
+    struct Waiter {
+        EventPoller::Ptr poller;
+        uint16_t port;
+        onResolved cb;
+    };
+
+    static void deliver(const Waiter &waiter, const SockException &err, const struct sockaddr_storage &addr);
+    void onDone(const std::string &key, bool success, const struct sockaddr_storage &addr);
+
+private:
+    std::mutex _mtx;
+    //正在解析的请求，key为域名加地址族等条件
+    std::unordered_map<std::string, std::vector<Waiter> > _pending;
+    //最后声明，析构时先停止线程池
+    std::unique_ptr<ThreadPool> _workers;
+};
+
+} // namespace FFZKit
+
+#endif //FFZKIT_DNSRESOLVER_H
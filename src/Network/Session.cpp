@@ -0,0 +1,61 @@
+//
+// Created by FFZero on 2025-06-28.
+//
+
+#include "Session.h"
+
+using namespace std;
+
+namespace FFZKit {
+
+StatisticImp(Session)
+
+Session::Session(const Socket::Ptr &sock) : _last_recv_ms(getCurrentMillisecond()), _sock(sock) {}
+
+ssize_t Session::send(Buffer::Ptr buf) {
+    return _sock->send(std::move(buf));
+}
+
+ssize_t Session::send(string buf) {
+    return _sock->send(std::move(buf));
+}
+
+ssize_t Session::send(const char *buf, size_t size) {
+    return _sock->send(buf, size);
+}
+
+void Session::shutdown(const SockException &ex) {
+    _sock->emitErr(ex);
+}
+
+uint64_t Session::getIdleTime() const {
+    auto now = getCurrentMillisecond();
+    auto recv_idle = now > _last_recv_ms ? now - _last_recv_ms : 0;
+    return (std::min)(recv_idle, _sock->elapsedTimeAfterFlushed());
+}
+
+const Socket::Ptr &Session::getSock() const {
+    return _sock;
+}
+
+const EventPoller::Ptr &Session::getPoller() const {
+    return _sock->getPoller();
+}
+
+string Session::get_local_ip() {
+    return _sock->get_local_ip();
+}
+
+uint16_t Session::get_local_port() {
+    return _sock->get_local_port();
+}
+
+string Session::get_peer_ip() {
+    return _sock->get_peer_ip();
+}
+
+uint16_t Session::get_peer_port() {
+    return _sock->get_peer_port();
+}
+
+} // namespace FFZKit
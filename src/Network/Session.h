@@ -0,0 +1,84 @@
+//
+// Created by FFZero on 2025-06-28.
+//
+
+#ifndef FFZKIT_SESSION_H
+#define FFZKIT_SESSION_H
+
+#include <string>
+#include <memory>
+#include "Network/Socket.h"
+
+namespace FFZKit {
+
+class TcpServer;
+
+/**
+ * tcp服务器会话基类，见TcpServer::start
+ * 会话在接受该连接的poller上创建，onRecv/onError/onManager均在该poller线程执行，访问会话状态无需加锁
+ * 子类需提供以const Socket::Ptr &为参数的构造函数
+ */
+class Session : public std::enable_shared_from_this<Session>, public noncopyable {
+public:
+    using Ptr = std::shared_ptr<Session>;
+
+    Session(const Socket::Ptr &sock);
+    virtual ~Session() = default;
+
+    /**
+     * 接收到数据，buf在回调后可继续持有
+     */
+    virtual void onRecv(const Buffer::Ptr &buf) = 0;
+
+    /**
+     * 连接断开(对端关闭、出错、空闲超时或者主动shutdown)，回调后会话从服务器中移除
+     */
+    virtual void onError(const SockException &err) = 0;
+
+    /**
+     * 服务器每次巡检时回调(约每秒一次)，可用于自定义的超时等定时逻辑
+     */
+    virtual void onManager() {}
+
+    /**
+     * 发送数据，线程安全
+     * @return -1代表失败(连接已断开)，其他为数据长度
+     */
+    ssize_t send(Buffer::Ptr buf);
+    ssize_t send(std::string buf);
+    ssize_t send(const char *buf, size_t size = 0);
+
+    /**
+     * 关闭会话，之后在poller线程回调onError
+     */
+    void shutdown(const SockException &ex = SockException(Err_shutdown, "self shutdown"));
+
+    /**
+     * 距离上次收到数据或者写出数据的毫秒数
+     */
+    uint64_t getIdleTime() const;
+
+    const Socket::Ptr &getSock() const;
+    const EventPoller::Ptr &getPoller() const;
+
+    std::string get_local_ip();
+    uint16_t get_local_port();
+    std::string get_peer_ip();
+    uint16_t get_peer_port();
+
+private:
+    friend class TcpServer;
+
+    // 上次收到数据的时间，只在poller线程访问
+    uint64_t _last_recv_ms;
+    // onError是否已回调(此时会话可能尚未加入服务器)，只在poller线程访问
+    bool _err_emit = false;
+    Socket::Ptr _sock;
+
+    //对象个数统计
+    ObjectStatistic<Session> _statistic;
+};
+
+} // namespace FFZKit
+
+#endif //FFZKIT_SESSION_H
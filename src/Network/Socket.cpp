@@ -0,0 +1,995 @@
+//
+// Created by FFZero on 2025-05-17.
+//
+
+#include <fcntl.h>
+#include "Socket.h"
+#include "DnsResolver.h"
+#include "Util/logger.h"
+
+using namespace std;
+
+namespace FFZKit {
+
+StatisticImp(Socket)
+
+//每次读事件最多读取次数，超出后让出给其他fd，见EventPoller::addBudgetEvent
+static constexpr size_t kMaxReadPerEvent = 16;
+//udp单次GSO发送的最大分段数(内核UDP_MAX_SEGMENTS)与最大负载
+static constexpr size_t kMaxGsoSegments = 64;
+static constexpr size_t kMaxUdpPayload = 65507;
+
+static SockException toSockException(int error) {
+    switch (error) {
+        case 0:
+        case UV_EAGAIN: return SockException(Err_success, "success");
+        case UV_ECONNREFUSED: return SockException(Err_refused, uv_strerror(error), error);
+        case UV_ETIMEDOUT: return SockException(Err_timeout, uv_strerror(error), error);
+        case UV_ECONNRESET: return SockException(Err_reset, uv_strerror(error), error);
+        default: return SockException(Err_other, uv_strerror(error), error);
+    }
+}
+
+static SockException getSockErr(int sock, bool try_errno = true) {
+    int error = SockUtil::getSockError(sock);
+    if (!error && try_errno) {
+        error = get_uv_error(true);
+    }
+    return toSockException(error);
+}
+
+ostream &operator<<(ostream &ost, const SockException &err) {
+    ost << err.getErrCode() << "(" << err.what() << ")";
+    return ost;
+}
+
+SockNum::~SockNum() {
+    if (_type == Sock_TCP) {
+        ::shutdown(_fd, SHUT_RDWR);
+    }
+    close(_fd);
+}
+
+Socket::Ptr Socket::createSocket(const EventPoller::Ptr &poller_in) {
+    auto poller = poller_in ? poller_in : EventPollerPool::Instance().getPoller();
+    return Socket::Ptr(new Socket(poller));
+}
+
+Socket::Socket(EventPoller::Ptr poller) {
+    _poller = std::move(poller);
+    setOnRead(nullptr);
+    setOnErr(nullptr);
+    setOnAccept(nullptr);
+    setOnFlush(nullptr);
+    setOnBeforeAccept(nullptr);
+}
+
+Socket::~Socket() {
+    closeSock();
+}
+
+void Socket::setOnRead(onReadCB cb) {
+    lock_guard<recursive_mutex> lck(_mtx_event);
+    if (cb) {
+        _on_read = std::move(cb);
+    } else {
+        _on_read = [](Buffer::Ptr &buf, struct sockaddr *, int) {
+            WarnL << "Socket not set read callback, data ignored: " << buf->size();
+        };
+    }
+}
+
+void Socket::setOnErr(onErrCB cb) {
+    lock_guard<recursive_mutex> lck(_mtx_event);
+    if (cb) {
+        _on_err = std::move(cb);
+    } else {
+        _on_err = [](const SockException &err) { WarnL << "Socket not set err callback, err: " << err; };
+    }
+}
+
+void Socket::setOnAccept(onAcceptCB cb) {
+    lock_guard<recursive_mutex> lck(_mtx_event);
+    if (cb) {
+        _on_accept = std::move(cb);
+    } else {
+        _on_accept = [](Socket::Ptr &sock) { WarnL << "Socket not set accept callback, peer fd: " << sock->rawFD(); };
+    }
+}
+
+void Socket::setOnFlush(onFlush cb) {
+    lock_guard<recursive_mutex> lck(_mtx_event);
+    if (cb) {
+        _on_flush = std::move(cb);
+    } else {
+        _on_flush = []() { return true; };
+    }
+}
+
+void Socket::setOnBeforeAccept(onCreateSocket cb) {
+    lock_guard<recursive_mutex> lck(_mtx_event);
+    if (cb) {
+        _on_before_accept = std::move(cb);
+    } else {
+        _on_before_accept = [](const EventPoller::Ptr &poller) { return nullptr; };
+    }
+}
+
+void Socket::connect(const string &url, uint16_t port, const onErrCB &con_cb, float timeout_sec,
+                     const string &local_ip, uint16_t local_port) {
+    weak_ptr<Socket> weak_self = shared_from_this();
+    // 切换到poller线程，连接状态只在poller线程访问
+    _poller->async([=]() {
+        if (auto strong_self = weak_self.lock()) {
+            strong_self->connect_l(url, port, con_cb, timeout_sec, local_ip, local_port);
+        }
+    });
+}
+
+void Socket::connect_l(const string &url, uint16_t port, const onErrCB &con_cb_in, float timeout_sec,
+                       const string &local_ip, uint16_t local_port) {
+    // 重置当前socket
+    closeSock();
+
+    weak_ptr<Socket> weak_self = shared_from_this();
+    auto con_cb = [con_cb_in, weak_self](const SockException &err) {
+        auto strong_self = weak_self.lock();
+        if (!strong_self) {
+            return;
+        }
+        {
+            lock_guard<recursive_mutex> lck(strong_self->_mtx_sock_fd);
+            strong_self->_async_con_cb = nullptr;
+            if (strong_self->_con_timer) {
+                strong_self->_con_timer->cancel();
+                strong_self->_con_timer = nullptr;
+            }
+        }
+        if (err) {
+            strong_self->closeSock();
+        }
+        con_cb_in(err);
+    };
+
+    auto async_con_cb = std::make_shared<onErrCB>(con_cb);
+    weak_ptr<onErrCB> weak_con_cb = async_con_cb;
+    {
+        lock_guard<recursive_mutex> lck(_mtx_sock_fd);
+        _async_con_cb = async_con_cb;
+        // 超时时间包含dns解析
+        _con_timer = _poller->doDelayTask((uint64_t)(timeout_sec * 1000), [weak_con_cb]() {
+            // 连接超时
+            if (auto strong_con_cb = weak_con_cb.lock()) {
+                (*strong_con_cb)(SockException(Err_timeout, uv_strerror(UV_ETIMEDOUT)));
+            }
+            return 0;
+        });
+    }
+
+    if (SockUtil::is_ipv4(url.data()) || SockUtil::is_ipv6(url.data())) {
+        connectTo(url, url, port, local_ip, local_port, async_con_cb);
+        return;
+    }
+    // 域名在dns线程池中解析，不阻塞poller线程
+    DnsResolver::Instance().resolve(url, port, _poller, [weak_self, weak_con_cb, url, port, local_ip, local_port](const SockException &err, const struct sockaddr_storage &addr) {
+        auto strong_self = weak_self.lock();
+        auto strong_con_cb = weak_con_cb.lock();
+        if (!strong_self || !strong_con_cb) {
+            // 已超时、关闭或者重新连接
+            return;
+        }
+        if (err) {
+            (*strong_con_cb)(err);
+            return;
+        }
+        strong_self->connectTo(url, SockUtil::inet_ntoa((struct sockaddr *)&addr), port, local_ip, local_port, strong_con_cb);
+    });
+}
+
+void Socket::connectTo(const string &url, const string &ip, uint16_t port, const string &local_ip, uint16_t local_port,
+                       const std::shared_ptr<onErrCB> &con_cb) {
+    auto fd = SockUtil::connect(ip.data(), port, true, local_ip.data(), local_port);
+    if (fd == -1) {
+        (*con_cb)(SockException(Err_other, StrPrinter << "connect to " << url << ":" << port << " failed: " << get_uv_errmsg(true)));
+        return;
+    }
+
+    auto sock = makeSock(fd, SockNum::Sock_TCP);
+    lock_guard<recursive_mutex> lck(_mtx_sock_fd);
+    setSock(sock);
+    if (!attachEvent(sock)) {
+        (*con_cb)(SockException(Err_other, "add event to poller failed when start connect"));
+    }
+}
+
+void Socket::onConnected(const SockFD::Ptr &sock, const onErrCB &cb) {
+    auto err = getSockErr(sock->rawFd(), false);
+    if (err) {
+        // 连接失败
+        cb(err);
+        return;
+    }
+    // 连接成功，不再需要监听可写事件
+    updateEvent(sock);
+    cb(err);
+}
+
+bool Socket::listen(uint16_t port, const string &local_ip, int backlog, bool reuse_port) {
+    closeSock();
+    int fd = SockUtil::listen(port, local_ip.data(), backlog, reuse_port);
+    if (fd == -1) {
+        return false;
+    }
+    auto sock = makeSock(fd, SockNum::Sock_TCP_Server);
+    setSock(sock);
+    if (!attachEvent(sock)) {
+        closeSock();
+        return false;
+    }
+    return true;
+}
+
+bool Socket::bindUdpSock(uint16_t port, const string &local_ip, bool enable_reuse) {
+    closeSock();
+    int fd = SockUtil::bindUdpSock(port, local_ip.data(), enable_reuse);
+    if (fd == -1) {
+        return false;
+    }
+    auto sock = makeSock(fd, SockNum::Sock_UDP);
+    setSock(sock);
+    if (!attachEvent(sock)) {
+        closeSock();
+        return false;
+    }
+    return true;
+}
+
+bool Socket::bindPeerAddr(const struct sockaddr *dst_addr, socklen_t addr_len) {
+    auto sock = cloneSockFD();
+    if (!sock || sock->type() != SockNum::Sock_UDP) {
+        return false;
+    }
+    addr_len = addr_len ? addr_len : SockUtil::get_sock_len(dst_addr);
+    if (-1 == ::connect(sock->rawFd(), dst_addr, addr_len)) {
+        WarnL << "Connect socket to peer address failed: " << SockUtil::inet_ntoa(dst_addr);
+        return false;
+    }
+    return true;
+}
+
+bool Socket::enableUdpGso(uint16_t segment_size) {
+    lock_guard<recursive_mutex> lck(_mtx_sock_fd);
+    if (!_sock_fd || _sock_fd->type() != SockNum::Sock_UDP) {
+        return false;
+    }
+    if (-1 == SockUtil::setUdpSegment(_sock_fd->rawFd(), segment_size)) {
+        return false;
+    }
+    lock_guard<recursive_mutex> lck_send(_mtx_send);
+    _udp_gso = segment_size;
+    return true;
+}
+
+bool Socket::enableUdpGro(bool enable) {
+    lock_guard<recursive_mutex> lck(_mtx_sock_fd);
+    if (!_sock_fd || _sock_fd->type() != SockNum::Sock_UDP) {
+        return false;
+    }
+    if (-1 == SockUtil::setUdpGro(_sock_fd->rawFd(), enable)) {
+        return false;
+    }
+    _udp_gro = enable;
+    return true;
+}
+
+bool Socket::enableZeroCopy(size_t min_size) {
+#if defined(HAS_EPOLL) && (defined(__linux__) || defined(__linux))
+    // 完成通知依赖epoll以EPOLLERR上报错误队列，select只会将其视为可读
+    lock_guard<recursive_mutex> lck(_mtx_sock_fd);
+    if (!_sock_fd || _sock_fd->type() != SockNum::Sock_TCP) {
+        return false;
+    }
+    lock_guard<recursive_mutex> lck_send(_mtx_send);
+    if (_zerocopy) {
+        return true;
+    }
+    if (!_send_buf || !_send_buf->empty()) {
+        // 发送缓存中可能有部分发送的数据，不能替换
+        return false;
+    }
+    if (-1 == SockUtil::setZeroCopy(_sock_fd->rawFd())) {
+        return false;
+    }
+    _send_buf = std::make_shared<BufferSendMsgZeroCopy>(min_size);
+    _zerocopy = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+SockFD::Ptr Socket::makeSock(int fd, SockNum::SockType type) {
+    return std::make_shared<SockFD>(std::make_shared<SockNum>(fd, type), _poller);
+}
+
+void Socket::setSock(SockFD::Ptr sock) {
+    lock_guard<recursive_mutex> lck(_mtx_sock_fd);
+    {
+        lock_guard<recursive_mutex> lck_send(_mtx_send);
+        auto type = sock->type();
+        _is_udp = type == SockNum::Sock_UDP;
+        _udp_gso = 0;
+        _zerocopy = false;
+        _send_buf = type == SockNum::Sock_TCP_Server ? nullptr : BufferList::create(_is_udp);
+    }
+    _sock_fd = std::move(sock);
+    _udp_gro = false;
+    _err_emit = false;
+    _last_flush_ms = getCurrentMillisecond();
+}
+
+SockFD::Ptr Socket::cloneSockFD() const {
+    lock_guard<recursive_mutex> lck(_mtx_sock_fd);
+    return _sock_fd;
+}
+
+bool Socket::attachEvent(const SockFD::Ptr &sock) {
+    weak_ptr<Socket> weak_self = shared_from_this();
+    weak_ptr<SockFD> weak_sock = sock;
+    if (sock->type() == SockNum::Sock_TCP_Server) {
+        // tcp服务器
+        return -1 != _poller->addEvent(sock->rawFd(), EventPoller::Event_Read | EventPoller::Event_Error, [weak_self, weak_sock](int event) {
+            auto strong_self = weak_self.lock();
+            auto strong_sock = weak_sock.lock();
+            if (strong_self && strong_sock) {
+                strong_self->onAccept(strong_sock, event);
+            }
+        });
+    }
+
+    int event = EventPoller::Event_Error;
+    if (_enable_recv) {
+        event |= EventPoller::Event_Read;
+    }
+    if (_async_con_cb) {
+        // 连接结果通过可写事件通知
+        event |= EventPoller::Event_Write;
+    }
+    // 每次读事件只读取有限次数，剩余数据由poller在下次循环中继续回调
+    return -1 != _poller->addBudgetEvent(sock->rawFd(), event, [weak_self, weak_sock](int event) {
+        auto strong_self = weak_self.lock();
+        auto strong_sock = weak_sock.lock();
+        if (!strong_self || !strong_sock) {
+            return false;
+        }
+        std::shared_ptr<onErrCB> con_cb;
+        {
+            lock_guard<recursive_mutex> lck(strong_self->_mtx_sock_fd);
+            con_cb = strong_self->_async_con_cb;
+        }
+        if (con_cb) {
+            // 连接中
+            strong_self->onConnected(strong_sock, *con_cb);
+            return false;
+        }
+        bool more = false;
+        if (event & EventPoller::Event_Read) {
+            more = strong_self->onRead(strong_sock);
+        }
+        if (event & EventPoller::Event_Write) {
+            strong_self->onWriteAble(strong_sock);
+        }
+        if (event & EventPoller::Event_Error) {
+            if (strong_self->onErrorQueue(strong_sock)) {
+                // 只是零拷贝完成通知
+                return more;
+            }
+            strong_self->emitErr(getSockErr(strong_sock->rawFd()));
+            return false;
+        }
+        return more;
+    });
+}
+
+void Socket::updateEvent(const SockFD::Ptr &sock) {
+    int event = EventPoller::Event_Error;
+    if (_enable_recv) {
+        event |= EventPoller::Event_Read;
+    }
+    if (_send_busy) {
+        event |= EventPoller::Event_Write;
+    }
+    _poller->modifyEvent(sock->rawFd(), event);
+}
+
+bool Socket::onRead(const SockFD::Ptr &sock) noexcept {
+    auto fd = sock->rawFd();
+    auto is_udp = sock->type() == SockNum::Sock_UDP;
+    auto buffer = _poller->getSharedBuffer(is_udp, is_udp && _udp_gro);
+    for (size_t i = 0; i < kMaxReadPerEvent; ++i) {
+        if (!_enable_recv) {
+            // 已暂停接收，数据留在内核缓存中
+            return false;
+        }
+        ssize_t count = 0;
+        auto nread = buffer->recvFromSocket(fd, count);
+        if (nread == 0 && !is_udp) {
+            emitErr(SockException(Err_eof, "end of file"));
+            return false;
+        }
+
+        if (nread == -1) {
+            auto err = get_uv_error(true);
+            if (err != UV_EAGAIN) {
+                if (!is_udp) {
+                    emitErr(toSockException(err));
+                } else {
+                    WarnL << "Recv err on udp socket[" << fd << "]: " << uv_strerror(err);
+                }
+            }
+            return false;
+        }
+
+        lock_guard<recursive_mutex> lck(_mtx_event);
+        for (ssize_t j = 0; j < count; ++j) {
+            socklen_t len;
+            auto addr = buffer->getAddress(j, len);
+            try {
+                _on_read(buffer->getBuffer(j), addr, len);
+            } catch (std::exception &ex) {
+                ErrorL << "Exception occurred when emit on_read: " << ex.what();
+            }
+        }
+
+        if (buffer->drained()) {
+            // 内核缓存已读空
+            return false;
+        }
+    }
+    // 读取次数达到预算，可能还有数据
+    return true;
+}
+
+bool Socket::onErrorQueue(const SockFD::Ptr &sock) {
+#if defined(__linux__) || defined(__linux)
+    {
+        lock_guard<recursive_mutex> lck(_mtx_send);
+        if (!_zerocopy || !_send_buf) {
+            return false;
+        }
+        // 错误队列中有数据时也会触发EPOLLERR
+        if (!static_cast<BufferSendMsgZeroCopy *>(_send_buf.get())->recvCompletion(sock->rawFd())) {
+            return false;
+        }
+    }
+    auto err = SockUtil::getSockError(sock->rawFd());
+    if (err) {
+        // 同时存在socket错误，SO_ERROR读取后即被清除，在此触发
+        emitErr(toSockException(err));
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Socket::onAccept(const SockFD::Ptr &sock, int event) noexcept {
+    int fd;
+    struct sockaddr_storage peer_addr;
+    socklen_t addr_len = sizeof(peer_addr);
+    while (true) {
+        if (event & EventPoller::Event_Read) {
+            do {
+                fd = (int)accept(sock->rawFd(), (struct sockaddr *)&peer_addr, &addr_len);
+            } while (-1 == fd && UV_EINTR == get_uv_error(true));
+
+            if (fd == -1) {
+                auto err = get_uv_error(true);
+                if (err != UV_EAGAIN) {
+                    ErrorL << "Accept socket failed: " << uv_strerror(err);
+                }
+                return;
+            }
+
+            SockUtil::setNoSigpipe(fd);
+            SockUtil::setNoBlocked(fd);
+            SockUtil::setNoDelay(fd);
+            SockUtil::setSendBuf(fd);
+            SockUtil::setRecvBuf(fd);
+            SockUtil::setCloseWait(fd);
+            SockUtil::setCloExec(fd);
+
+            Socket::Ptr peer_sock;
+            try {
+                // 此处捕获异常，防止socket未accept尽，epoll边沿触发失效的问题
+                lock_guard<recursive_mutex> lck(_mtx_event);
+                peer_sock = _on_before_accept(_poller);
+            } catch (std::exception &ex) {
+                ErrorL << "Exception occurred when emit on_before_accept: " << ex.what();
+                close(fd);
+                continue;
+            }
+
+            if (!peer_sock) {
+                // 此处是默认构造行为，也就是子Socket共用父Socket的poll线程
+                peer_sock = Socket::createSocket(_poller);
+            }
+
+            auto peer_sock_fd = peer_sock->makeSock(fd, SockNum::Sock_TCP);
+            peer_sock->setSock(peer_sock_fd);
+
+            try {
+                // 先设置新socket的回调再监听其事件
+                lock_guard<recursive_mutex> lck(_mtx_event);
+                _on_accept(peer_sock);
+            } catch (std::exception &ex) {
+                ErrorL << "Exception occurred when emit on_accept: " << ex.what();
+                continue;
+            }
+
+            if (peer_sock->cloneSockFD() != peer_sock_fd) {
+                // 在on_accept中已被关闭
+                continue;
+            }
+            if (!peer_sock->attachEvent(peer_sock_fd)) {
+                // 监听事件失败，直接关闭
+                peer_sock->emitErr(SockException(Err_other, "add event to poller failed when accept a socket"));
+            }
+        }
+
+        if (event & EventPoller::Event_Error) {
+            auto ex = getSockErr(sock->rawFd());
+            emitErr(ex);
+            ErrorL << "TCP listener occurred a err: " << ex;
+            return;
+        }
+    }
+}
+
+void Socket::onWriteAble(const SockFD::Ptr &sock) {
+    bool drained = false;
+    {
+        lock_guard<recursive_mutex> lck(_mtx_sock_fd);
+        if (_sock_fd != sock) {
+            return;
+        }
+        flushData(sock, drained);
+    }
+    if (drained) {
+        onFlushed();
+    }
+}
+
+bool Socket::flushData(const SockFD::Ptr &sock, bool &drained) {
+    {
+        lock_guard<recursive_mutex> lck(_mtx_send);
+        if (_send_buf && !_send_buf->empty()) {
+            // 一次系统调用合并发送多个Buffer
+            auto n = _send_buf->send(sock->rawFd(), FLAG_NOSIGNAL);
+            if (!_send_buf->empty()) {
+                auto err = get_uv_error(true);
+                if (n > 0) {
+                    _last_flush_ms = getCurrentMillisecond();
+                }
+                if (err == UV_EAGAIN) {
+                    // 内核缓存已满，等待可写事件
+                    startWriteAbleEvent(sock);
+                    return true;
+                }
+                emitErr(toSockException(err));
+                return false;
+            }
+        }
+        _last_flush_ms = getCurrentMillisecond();
+    }
+
+    if (_send_busy) {
+        // 发送缓存已清空，停止监听可写事件
+        stopWriteAbleEvent(sock);
+        drained = true;
+    }
+    return true;
+}
+
+void Socket::onFlushed() {
+    bool flag;
+    {
+        lock_guard<recursive_mutex> lck(_mtx_event);
+        flag = _on_flush();
+    }
+    if (!flag) {
+        setOnFlush(nullptr);
+    }
+}
+
+void Socket::startWriteAbleEvent(const SockFD::Ptr &sock) {
+    if (_send_busy.exchange(true)) {
+        return;
+    }
+    updateEvent(sock);
+    if (_send_timer || !_max_send_buffer_ms) {
+        return;
+    }
+    weak_ptr<Socket> weak_self = shared_from_this();
+    _send_timer = _poller->doDelayTask(_max_send_buffer_ms, [weak_self]() -> uint64_t {
+        auto strong_self = weak_self.lock();
+        if (!strong_self) {
+            return 0;
+        }
+        lock_guard<recursive_mutex> lck(strong_self->_mtx_sock_fd);
+        lock_guard<recursive_mutex> lck_send(strong_self->_mtx_send);
+        if (!strong_self->_send_busy) {
+            strong_self->_send_timer = nullptr;
+            return 0;
+        }
+        auto elapsed = strong_self->elapsedTimeAfterFlushed();
+        if (elapsed < strong_self->_max_send_buffer_ms) {
+            // 期间有数据写出，继续等待
+            return strong_self->_max_send_buffer_ms - elapsed;
+        }
+        strong_self->_send_timer = nullptr;
+        strong_self->emitErr(SockException(Err_timeout, "socket send timeout"));
+        return 0;
+    });
+}
+
+void Socket::stopWriteAbleEvent(const SockFD::Ptr &sock) {
+    if (!_send_busy.exchange(false)) {
+        return;
+    }
+    updateEvent(sock);
+}
+
+ssize_t Socket::send(const char *buf, size_t size, struct sockaddr *addr, socklen_t addr_len, bool try_flush) {
+    if (size <= 0) {
+        size = strlen(buf);
+        if (!size) {
+            return 0;
+        }
+    }
+    auto ptr = BufferRaw::create();
+    ptr->assign(buf, size);
+    return send(std::move(ptr), addr, addr_len, try_flush);
+}
+
+ssize_t Socket::send(string buf, struct sockaddr *addr, socklen_t addr_len, bool try_flush) {
+    return send(buf.data(), buf.size(), addr, addr_len, try_flush);
+}
+
+ssize_t Socket::send(Buffer::Ptr buf, struct sockaddr *addr, socklen_t addr_len, bool try_flush) {
+    auto size = buf ? buf->size() : 0;
+    if (!size) {
+        return 0;
+    }
+
+    size_t gso_max = 0;
+    {
+        lock_guard<recursive_mutex> lck_send(_mtx_send);
+        if (_is_udp && _udp_gso) {
+            // 单次GSO发送的分段数与负载均有上限
+            gso_max = (std::min)(kMaxGsoSegments, kMaxUdpPayload / _udp_gso) * _udp_gso;
+        }
+    }
+    if (gso_max && size > gso_max) {
+        // 拆分为多次GSO发送，各段引用原Buffer，最后一次sendmmsg批量发出
+        for (size_t offset = 0; offset < size; offset += gso_max) {
+            if (-1 == send(std::make_shared<BufferOffset>(buf, offset, gso_max), addr, addr_len, false)) {
+                return -1;
+            }
+        }
+        if (try_flush && flushAll()) {
+            return -1;
+        }
+        return size;
+    }
+
+    if (try_flush) {
+        lock_guard<recursive_mutex> lck(_mtx_sock_fd);
+        lock_guard<recursive_mutex> lck_send(_mtx_send);
+        if (_is_udp && _sock_fd && _send_buf && _send_buf->empty() && !_send_busy) {
+            // 没有排队的数据报时直接发送，省去入队开销；只有内核缓存已满时才入队
+            addr_len = addr ? (addr_len ? addr_len : SockUtil::get_sock_len(addr)) : 0;
+            auto n = ::sendto(_sock_fd->rawFd(), buf->data(), size, FLAG_NOSIGNAL, addr, addr_len);
+            if (n != -1 || get_uv_error(true) != UV_EAGAIN) {
+                // 发送出错的数据报直接丢弃，与批量发送一致
+                return size;
+            }
+        }
+    }
+
+    {
+        lock_guard<recursive_mutex> lck(_mtx_send);
+        if (!_send_buf) {
+            // 未连接或者已关闭
+            return -1;
+        }
+        if (_is_udp) {
+            // udp数据报需携带各自的目标地址
+            buf = std::make_shared<BufferSock>(std::move(buf), addr, addr_len);
+        }
+        _send_buf->append(std::move(buf));
+    }
+
+    if (try_flush && flushAll()) {
+        return -1;
+    }
+    return size;
+}
+
+bool Socket::sendFile(const string &path, uint64_t offset, uint64_t size, onSendFileCB cb, bool try_flush) {
+    auto file = BufferFile::create(path, offset, size);
+    if (!file) {
+        return false;
+    }
+    {
+        lock_guard<recursive_mutex> lck(_mtx_send);
+        if (!_send_buf || _is_udp) {
+            return false;
+        }
+        if (cb) {
+            auto poller = _poller;
+            auto total = file->size();
+            // 发送完毕或者被发送缓存丢弃时回调，此时可能持有socket的锁，切换至poller线程执行
+            file->setOnComplete([poller, cb, total](uint64_t sent) {
+                poller->async([cb, total, sent]() {
+                    cb(sent == total ? SockException() : SockException(Err_shutdown, "send file canceled"), sent);
+                }, false);
+            });
+        }
+        _send_buf->appendFile(std::move(file));
+    }
+    if (try_flush) {
+        flushAll();
+    }
+    return true;
+}
+
+int Socket::flushAll() {
+    lock_guard<recursive_mutex> lck(_mtx_sock_fd);
+    if (!_sock_fd) {
+        // 如果已断开连接或者发送超时
+        return -1;
+    }
+    if (_send_busy) {
+        // 等待可写事件后再发送
+        return 0;
+    }
+    bool drained = false;
+    if (!flushData(_sock_fd, drained)) {
+        return -1;
+    }
+    if (drained) {
+        weak_ptr<Socket> weak_self = shared_from_this();
+        _poller->async([weak_self]() {
+            if (auto strong_self = weak_self.lock()) {
+                strong_self->onFlushed();
+            }
+        });
+    }
+    return 0;
+}
+
+bool Socket::emitErr(const SockException &err) noexcept {
+    if (_err_emit.exchange(true)) {
+        return true;
+    }
+    closeSock();
+    weak_ptr<Socket> weak_self = shared_from_this();
+    _poller->async([weak_self, err]() {
+        auto strong_self = weak_self.lock();
+        if (!strong_self) {
+            return;
+        }
+        lock_guard<recursive_mutex> lck(strong_self->_mtx_event);
+        try {
+            strong_self->_on_err(err);
+        } catch (std::exception &ex) {
+            ErrorL << "Exception occurred when emit on_err: " << ex.what();
+        }
+    });
+    return true;
+}
+
+void Socket::enableRecv(bool enabled) {
+    if (_enable_recv.exchange(enabled) == enabled) {
+        return;
+    }
+    auto sock = cloneSockFD();
+    if (sock && sock->type() != SockNum::Sock_TCP_Server) {
+        // 重新开启时epoll会重新检查可读状态，不会丢失内核缓存中的数据
+        updateEvent(sock);
+    }
+}
+
+#if defined(HAS_EPOLL) && (defined(__linux__) || defined(__linux))
+//关闭后等待零拷贝完成通知的最长时间，超时则重置连接
+static constexpr uint64_t kZeroCopyDrainMs = 10 * 1000;
+
+/**
+ * 关闭时内核可能仍在发送零拷贝引用的Buffer，此时释放Buffer会使其被复用改写，对端收到错误的数据
+ * 复制一个fd引用同一socket，原fd照常关闭(正常发送FIN)，在复制的fd上读取完成通知，全部确认后再释放Buffer并关闭；
+ * 超时仍未确认则以SO_LINGER{1,0}重置连接，丢弃内核中未发送的数据后再释放
+ */
+static void drainZeroCopy(const EventPoller::Ptr &poller, int raw_fd, std::shared_ptr<BufferSendMsgZeroCopy> send_buf) {
+    int fd = fcntl(raw_fd, F_DUPFD_CLOEXEC, 0);
+    if (fd == -1) {
+        WarnL << "Dup fd failed, reset connection with pending zerocopy buffers: " << get_uv_errmsg(true);
+        linger abort_linger { 1, 0 };
+        setsockopt(raw_fd, SOL_SOCKET, SO_LINGER, (char *)&abort_linger, sizeof(abort_linger));
+        return;
+    }
+
+    struct Drain {
+        int fd;
+        std::shared_ptr<BufferSendMsgZeroCopy> send_buf;
+        EventPoller::DelayTask::Ptr timer;
+    };
+    auto drain = std::make_shared<Drain>();
+    drain->fd = fd;
+    drain->send_buf = std::move(send_buf);
+
+    // 只在poller线程调用
+    auto finish = [poller](const std::shared_ptr<Drain> &drain) {
+        if (drain->fd == -1) {
+            return;
+        }
+        if (drain->timer) {
+            drain->timer->cancel();
+            drain->timer = nullptr;
+        }
+        if (drain->send_buf->pinnedCount()) {
+            WarnL << "Zerocopy completion timeout, reset connection, pending buffers: " << drain->send_buf->pinnedCount();
+            linger abort_linger { 1, 0 };
+            setsockopt(drain->fd, SOL_SOCKET, SO_LINGER, (char *)&abort_linger, sizeof(abort_linger));
+        }
+        auto fd = drain->fd;
+        drain->fd = -1;
+        poller->delEvent(fd, [fd](bool) { close(fd); });
+        drain->send_buf = nullptr;
+    };
+
+    // 回调持有drain直到移除监听
+    auto ret = poller->addEvent(fd, EventPoller::Event_Error, [drain, finish](int) {
+        if (drain->fd == -1) {
+            return;
+        }
+        drain->send_buf->recvCompletion(drain->fd);
+        if (!drain->send_buf->pinnedCount()) {
+            finish(drain);
+        }
+    });
+    if (ret == -1) {
+        WarnL << "Add zerocopy drain event failed, reset connection: " << get_uv_errmsg(true);
+        linger abort_linger { 1, 0 };
+        setsockopt(fd, SOL_SOCKET, SO_LINGER, (char *)&abort_linger, sizeof(abort_linger));
+        close(fd);
+        return;
+    }
+    weak_ptr<Drain> weak_drain = drain;
+    poller->async([poller, weak_drain, finish]() {
+        auto drain = weak_drain.lock();
+        if (!drain || drain->fd == -1) {
+            return;
+        }
+        // 添加监听前已到达的通知不会再触发事件
+        drain->send_buf->recvCompletion(drain->fd);
+        if (!drain->send_buf->pinnedCount()) {
+            finish(drain);
+            return;
+        }
+        drain->timer = poller->doDelayTask(kZeroCopyDrainMs, [weak_drain, finish]() {
+            if (auto drain = weak_drain.lock()) {
+                finish(drain);
+            }
+            return 0;
+        });
+    });
+}
+#endif
+
+void Socket::closeSock() {
+    // 被丢弃的发送缓存在释放锁后析构，其中未发送完毕的文件在此时回调发送结束
+    BufferList::Ptr send_buf_dropped;
+    lock_guard<recursive_mutex> lck(_mtx_sock_fd);
+    _async_con_cb = nullptr;
+    if (_con_timer) {
+        _con_timer->cancel();
+        _con_timer = nullptr;
+    }
+    {
+        lock_guard<recursive_mutex> lck_send(_mtx_send);
+        if (_send_timer) {
+            _send_timer->cancel();
+            _send_timer = nullptr;
+        }
+#if defined(HAS_EPOLL) && (defined(__linux__) || defined(__linux))
+        if (_zerocopy && _send_buf && _sock_fd) {
+            auto send_buf = static_pointer_cast<BufferSendMsgZeroCopy>(_send_buf);
+            send_buf->recvCompletion(_sock_fd->rawFd());
+            if (send_buf->pinnedCount()) {
+                // 仍被内核引用的Buffer不能随socket关闭释放
+                drainZeroCopy(_poller, _sock_fd->rawFd(), std::move(send_buf));
+            }
+        }
+#endif
+        send_buf_dropped = std::move(_send_buf);
+        _zerocopy = false;
+    }
+    _send_busy = false;
+    _sock_fd = nullptr;
+}
+
+int Socket::rawFD() const {
+    lock_guard<recursive_mutex> lck(_mtx_sock_fd);
+    return _sock_fd ? _sock_fd->rawFd() : -1;
+}
+
+bool Socket::alive() const {
+    lock_guard<recursive_mutex> lck(_mtx_sock_fd);
+    return _sock_fd && !_err_emit;
+}
+
+SockNum::SockType Socket::sockType() const {
+    lock_guard<recursive_mutex> lck(_mtx_sock_fd);
+    return _sock_fd ? _sock_fd->type() : SockNum::Sock_Invalid;
+}
+
+void Socket::setSendTimeOutSecond(uint32_t second) {
+    _max_send_buffer_ms = second * 1000;
+}
+
+bool Socket::isSocketBusy() const {
+    return _send_busy;
+}
+
+size_t Socket::getSendBufferCount() {
+    lock_guard<recursive_mutex> lck(_mtx_send);
+    return _send_buf ? _send_buf->count() : 0;
+}
+
+size_t Socket::getSendBufferSize() {
+    lock_guard<recursive_mutex> lck(_mtx_send);
+    return _send_buf ? _send_buf->size() : 0;
+}
+
+size_t Socket::getZeroCopyPendingCount() {
+#if defined(__linux__) || defined(__linux)
+    lock_guard<recursive_mutex> lck(_mtx_send);
+    if (_zerocopy && _send_buf) {
+        return static_cast<BufferSendMsgZeroCopy *>(_send_buf.get())->pinnedCount();
+    }
+#endif
+    return 0;
+}
+
+uint64_t Socket::elapsedTimeAfterFlushed() {
+    auto now = getCurrentMillisecond();
+    auto last = _last_flush_ms.load();
+    return now > last ? now - last : 0;
+}
+
+const EventPoller::Ptr &Socket::getPoller() const {
+    return _poller;
+}
+
+string Socket::get_local_ip() {
+    auto sock = cloneSockFD();
+    return sock ? SockUtil::get_local_ip(sock->rawFd()) : "";
+}
+
+uint16_t Socket::get_local_port() {
+    auto sock = cloneSockFD();
+    return sock ? SockUtil::get_local_port(sock->rawFd()) : 0;
+}
+
+string Socket::get_peer_ip() {
+    auto sock = cloneSockFD();
+    return sock ? SockUtil::get_peer_ip(sock->rawFd()) : "";
+}
+
+uint16_t Socket::get_peer_port() {
+    auto sock = cloneSockFD();
+    return sock ? SockUtil::get_peer_port(sock->rawFd()) : 0;
+}
+
+} // namespace FFZKit
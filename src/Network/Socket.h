@@ -0,0 +1,430 @@
+//
+// Created by FFZero on 2025-05-17.
+//
+
+#ifndef FFZKIT_SOCKET_H
+#define FFZKIT_SOCKET_H
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <functional>
+#include "Util/util.h"
+#include "Util/uv_errno.h"
+#include "Poller/EventPoller.h"
+#include "Network/Buffer.h"
+#include "Network/BufferSock.h"
+#include "Network/sockutil.h"
+
+namespace FFZKit {
+
+#if defined(MSG_NOSIGNAL)
+#define FLAG_NOSIGNAL MSG_NOSIGNAL
+#else
+#define FLAG_NOSIGNAL 0
+#endif //MSG_NOSIGNAL
+
+//默认的socket发送超时时间，单位秒
+#define SEND_TIME_OUT_SEC 10
+
+//错误类型枚举
+typedef enum {
+    Err_success = 0, //成功
+    Err_eof, //eof
+    Err_timeout, //超时
+    Err_refused,//连接被拒绝
+    Err_reset,//连接被重置
+    Err_dns,//dns解析失败
+    Err_shutdown,//主动关闭
+    Err_other = 0xFF,//其他错误
+} ErrCode;
+
+//错误信息类
+class SockException : public std::exception {
+public:
+    SockException(ErrCode code = Err_success, const std::string &msg = "", int custom_code = 0) {
+        _msg = msg;
+        _code = code;
+        _custom_code = custom_code;
+    }
+
+    //重置错误
+    void reset(ErrCode code, const std::string &msg, int custom_code = 0) {
+        _msg = msg;
+        _code = code;
+        _custom_code = custom_code;
+    }
+
+    //错误提示
+    const char *what() const noexcept override {
+        return _msg.c_str();
+    }
+
+    //错误代码
+    ErrCode getErrCode() const {
+        return _code;
+    }
+
+    //用户自定义错误代码，一般为uv错误码
+    int getCustomCode() const {
+        return _custom_code;
+    }
+
+    //判断是否真的有错
+    operator bool() const {
+        return _code != Err_success;
+    }
+
+private:
+    ErrCode _code;
+    int _custom_code = 0;
+    std::string _msg;
+};
+
+std::ostream &operator<<(std::ostream &ost, const SockException &err);
+
+//socket fd的持有者，析构时关闭fd
+class SockNum {
+public:
+    using Ptr = std::shared_ptr<SockNum>;
+
+    typedef enum {
+        Sock_Invalid = -1,
+        Sock_TCP = 0,
+        Sock_UDP = 1,
+        Sock_TCP_Server = 2
+    } SockType;
+
+    SockNum(int fd, SockType type) {
+        _fd = fd;
+        _type = type;
+    }
+
+    ~SockNum();
+
+    int rawFd() const {
+        return _fd;
+    }
+
+    SockType type() const {
+        return _type;
+    }
+
+private:
+    int _fd;
+    SockType _type;
+};
+
+//socket fd与其所在poller的绑定，析构时先移除事件监听再关闭fd，防止fd被复用后误删监听
+class SockFD : public noncopyable {
+public:
+    using Ptr = std::shared_ptr<SockFD>;
+
+    SockFD(SockNum::Ptr num, const EventPoller::Ptr &poller) {
+        _num = std::move(num);
+        _poller = poller;
+    }
+
+    ~SockFD() {
+        auto num = _num;
+        _poller->delEvent(_num->rawFd(), [num](bool) {});
+    }
+
+    int rawFd() const {
+        return _num->rawFd();
+    }
+
+    SockNum::SockType type() const {
+        return _num->type();
+    }
+
+    const EventPoller::Ptr &getPoller() const {
+        return _poller;
+    }
+
+private:
+    SockNum::Ptr _num;
+    EventPoller::Ptr _poller;
+};
+
+/**
+ * 基于EventPoller的异步socket，支持tcp客户端、tcp监听与udp
+ * 事件回调均在所属poller线程执行；send等接口线程安全
+ * 读取时使用poller内所有socket共享的读缓存，见EventPoller::getSharedBuffer；linux下udp使用recvmmsg批量读取，并可开启GSO/GRO分段卸载
+ * 发送时先写入发送缓存，内核缓存写满后等待可写事件，可通过isSocketBusy/getSendBufferSize/onFlush实现背压
+ */
+class Socket : public std::enable_shared_from_this<Socket>, public noncopyable {
+public:
+    using Ptr = std::shared_ptr<Socket>;
+    //接收数据回调，buf在回调后可继续持有
+    using onReadCB = std::function<void(Buffer::Ptr &buf, struct sockaddr *addr, int addr_len)>;
+    using onErrCB = std::function<void(const SockException &err)>;
+    //tcp监听接收到连接回调，在此设置新socket的回调
+    using onAcceptCB = std::function<void(Socket::Ptr &sock)>;
+    //发送缓存清空回调，返回false则不再回调
+    using onFlush = std::function<bool()>;
+    //tcp监听接收到连接前，用于自定义新socket所在poller
+    using onCreateSocket = std::function<Ptr(const EventPoller::Ptr &poller)>;
+    //文件发送结束回调，err为空代表发送完毕，sent为已写入socket的字节数
+    using onSendFileCB = std::function<void(const SockException &err, uint64_t sent)>;
+
+    /**
+     * 构造socket对象
+     * @param poller 所属poller，为空时从EventPollerPool中获取
+     */
+    static Ptr createSocket(const EventPoller::Ptr &poller = nullptr);
+    ~Socket();
+
+    /**
+     * 创建tcp客户端并异步连接服务器
+     * @param url 目标服务器ip或域名
+     * @param port 目标服务器端口
+     * @param con_cb 结果回调
+     * @param timeout_sec 超时时间
+     * @param local_ip 绑定本地网卡ip
+     * @param local_port 绑定本地网卡端口号
+     */
+    void connect(const std::string &url, uint16_t port, const onErrCB &con_cb, float timeout_sec = 5,
+                 const std::string &local_ip = "::", uint16_t local_port = 0);
+
+    /**
+     * 创建tcp监听服务器
+     * @param port 监听端口，0则随机
+     * @param local_ip 监听的网卡ip
+     * @param backlog tcp最大积压数
+     * @param reuse_port 是否开启SO_REUSEPORT，可在多个poller上分别监听同一端口
+     * @return 是否成功
+     */
+    bool listen(uint16_t port, const std::string &local_ip = "::", int backlog = 1024, bool reuse_port = false);
+
+    /**
+     * 创建udp套接字
+     * @param port 绑定的端口为0则随机
+     * @param local_ip 绑定的网卡ip
+     * @param enable_reuse 是否允许重复bind端口
+     * @return 是否成功
+     */
+    bool bindUdpSock(uint16_t port, const std::string &local_ip = "::", bool enable_reuse = true);
+
+    /**
+     * 绑定udp目标地址，之后send不传地址时发送至该地址
+     * @param dst_addr 目标地址
+     * @param addr_len 目标地址长度，为0时自动获取
+     * @return 是否成功
+     */
+    bool bindPeerAddr(const struct sockaddr *dst_addr, socklen_t addr_len = 0);
+
+    /**
+     * 开启udp发送分段卸载(GSO，仅linux)，需在bindUdpSock之后调用
+     * 开启后大于segment_size的Buffer一次系统调用即可发送为多个segment_size大小的数据报(最后一个可以更小)，
+     * 超过单次发送上限(64个分段或64KB)的Buffer自动拆分为多段，不拷贝数据；接收端看到的是独立的数据报
+     * @param segment_size 分段大小(每个数据报的负载大小)，0为关闭
+     * @return 是否成功，系统不支持时返回false，此时大Buffer仍按单个数据报发送
+     */
+    bool enableUdpGso(uint16_t segment_size);
+
+    /**
+     * 开启udp接收合并(GRO，仅linux)，需在bindUdpSock之后调用
+     * 开启后内核可将同一来源连续的同尺寸数据报合并为一次读取，再按分段大小拆分为各个数据报的Buffer视图回调，不拷贝数据；
+     * 此时使用poller共享的大块读缓存(每个数据报缓存64KB)，长期持有回调的Buffer会占用整块缓存
+     * @param enable 是否开启
+     * @return 是否成功，系统不支持时返回false
+     */
+    bool enableUdpGro(bool enable = true);
+
+    /**
+     * 开启tcp零拷贝发送(MSG_ZEROCOPY，仅linux epoll)，需在连接建立之后、发送数据之前调用，开启后不可关闭
+     * 内核直接引用发送的Buffer，Buffer在收到完成通知(错误队列，以Event_Error上报)之前保持持有，之后释放回各自的缓存池；
+     * 适合大块数据推送，发送后不能再修改Buffer内容；回环网卡上内核仍会拷贝
+     * @param min_size 待发送数据不小于该值时才使用零拷贝，较小的写入使用普通拷贝发送
+     * @return 是否成功，系统不支持、非tcp连接或者发送缓存不为空时返回false
+     */
+    bool enableZeroCopy(size_t min_size = 16 * 1024);
+
+    /**
+     * 已发送但尚未收到零拷贝完成通知的Buffer个数
+     */
+    size_t getZeroCopyPendingCount();
+
+    ////////////设置事件回调////////////
+
+    void setOnRead(onReadCB cb);
+    void setOnErr(onErrCB cb);
+    void setOnAccept(onAcceptCB cb);
+    void setOnFlush(onFlush cb);
+    void setOnBeforeAccept(onCreateSocket cb);
+
+    ////////////发送数据相关接口////////////
+
+    /**
+     * 发送数据，线程安全
+     * 数据先写入发送缓存，尽量合并多个Buffer为一次系统调用发送；udp每个Buffer为一个数据报，linux下使用sendmmsg批量发送，
+     * 批量发送udp时应设置try_flush为false，最后再调用flushAll
+     * @param buf 数据
+     * @param addr 目标地址，仅udp有效，为空时发送至bindPeerAddr绑定的地址
+     * @param addr_len 目标地址长度
+     * @param try_flush 是否尝试立即发送
+     * @return -1代表失败(socket无效)，其他为数据长度
+     */
+    ssize_t send(const char *buf, size_t size = 0, struct sockaddr *addr = nullptr, socklen_t addr_len = 0, bool try_flush = true);
+    ssize_t send(std::string buf, struct sockaddr *addr = nullptr, socklen_t addr_len = 0, bool try_flush = true);
+    ssize_t send(Buffer::Ptr buf, struct sockaddr *addr = nullptr, socklen_t addr_len = 0, bool try_flush = true);
+
+    /**
+     * 发送文件区间(仅tcp)，线程安全
+     * 文件内容不读入内存，与send的数据按调用顺序发送；linux下由sendfile直接发送，不支持sendfile的文件经管道splice，
+     * 内核缓存写满后由可写事件驱动续传，背压与超时同send(isSocketBusy/onFlush/setSendTimeOutSecond)
+     * @param path 文件路径
+     * @param offset 起始偏移
+     * @param size 发送长度，0为到文件末尾
+     * @param cb 发送结束回调，在poller线程执行；socket关闭导致未发送完毕时err为Err_shutdown
+     * @param try_flush 是否尝试立即发送
+     * @return 是否加入发送缓存，文件打开失败、区间越界或者socket无效时返回false且不回调
+     */
+    bool sendFile(const std::string &path, uint64_t offset = 0, uint64_t size = 0, onSendFileCB cb = nullptr, bool try_flush = true);
+
+    /**
+     * 尝试发送发送缓存中的数据，正在等待可写事件时不重复发送
+     * @return -1代表失败(socket无效或者发送出错)，0为成功
+     */
+    int flushAll();
+
+    /**
+     * 触发on_err回调并关闭socket，同一次连接只回调一次
+     */
+    bool emitErr(const SockException &err) noexcept;
+
+    /**
+     * 开启或关闭数据接收，关闭后数据留在内核缓存中，可用于读端背压
+     */
+    void enableRecv(bool enabled);
+
+    /**
+     * 关闭socket，清空发送缓存
+     */
+    void closeSock();
+
+    /**
+     * 获取裸fd，socket无效时返回-1
+     */
+    int rawFD() const;
+
+    /**
+     * socket是否有效
+     */
+    bool alive() const;
+
+    /**
+     * 获取socket类型
+     */
+    SockNum::SockType sockType() const;
+
+    /**
+     * 设置发送超时，超时后触发on_err(Err_timeout)
+     * @param second 发送缓存持续这么长时间未能写出数据视为超时，0为不限制
+     */
+    void setSendTimeOutSecond(uint32_t second);
+
+    /**
+     * 内核发送缓存已满，正在等待可写事件，此时应暂停发送，待onFlush回调后继续
+     */
+    bool isSocketBusy() const;
+
+    /**
+     * 发送缓存中的Buffer个数
+     */
+    size_t getSendBufferCount();
+
+    /**
+     * 发送缓存中未发送的字节数
+     */
+    size_t getSendBufferSize();
+
+    /**
+     * 距离上次写出数据或者清空发送缓存的毫秒数
+     */
+    uint64_t elapsedTimeAfterFlushed();
+
+    /**
+     * 获取所属poller
+     */
+    const EventPoller::Ptr &getPoller() const;
+
+    std::string get_local_ip();
+    uint16_t get_local_port();
+    std::string get_peer_ip();
+    uint16_t get_peer_port();
+
+private:
+    Socket(EventPoller::Ptr poller);
+
+    void setSock(SockFD::Ptr sock);
+    SockFD::Ptr cloneSockFD() const;
+    SockFD::Ptr makeSock(int fd, SockNum::SockType type);
+    bool attachEvent(const SockFD::Ptr &sock);
+    void updateEvent(const SockFD::Ptr &sock);
+
+    void connect_l(const std::string &url, uint16_t port, const onErrCB &con_cb_in, float timeout_sec,
+                   const std::string &local_ip, uint16_t local_port);
+    void connectTo(const std::string &url, const std::string &ip, uint16_t port, const std::string &local_ip,
+                   uint16_t local_port, const std::shared_ptr<onErrCB> &con_cb);
+    void onConnected(const SockFD::Ptr &sock, const onErrCB &cb);
+    void onAccept(const SockFD::Ptr &sock, int event) noexcept;
+    bool onRead(const SockFD::Ptr &sock) noexcept;
+    bool onErrorQueue(const SockFD::Ptr &sock);
+    void onWriteAble(const SockFD::Ptr &sock);
+    void onFlushed();
+
+    /**
+     * 发送缓存中的数据，调用前需持有_mtx_sock_fd
+     * @param drained 是否从等待可写状态变为发送缓存已清空
+     * @return 是否成功，失败时已触发on_err
+     */
+    bool flushData(const SockFD::Ptr &sock, bool &drained);
+    void startWriteAbleEvent(const SockFD::Ptr &sock);
+    void stopWriteAbleEvent(const SockFD::Ptr &sock);
+
+private:
+    EventPoller::Ptr _poller;
+
+    mutable std::recursive_mutex _mtx_sock_fd;
+    SockFD::Ptr _sock_fd;
+
+    std::recursive_mutex _mtx_event;
+    onErrCB _on_err;
+    onReadCB _on_read;
+    onAcceptCB _on_accept;
+    onFlush _on_flush;
+    onCreateSocket _on_before_accept;
+
+    //发送缓存，socket无效时为空
+    std::recursive_mutex _mtx_send;
+    BufferList::Ptr _send_buf;
+    bool _is_udp = false;
+    //udp发送分段大小，0为未开启GSO
+    uint16_t _udp_gso = 0;
+    //udp是否开启GRO接收
+    std::atomic<bool> _udp_gro { false };
+    //tcp是否开启零拷贝发送，此时_send_buf为BufferSendMsgZeroCopy
+    bool _zerocopy = false;
+
+    //是否正在等待可写事件
+    std::atomic<bool> _send_busy { false };
+    std::atomic<bool> _enable_recv { true };
+    std::atomic<bool> _err_emit { false };
+    std::atomic<uint64_t> _last_flush_ms { 0 };
+    uint32_t _max_send_buffer_ms = SEND_TIME_OUT_SEC * 1000;
+    EventPoller::DelayTask::Ptr _send_timer;
+
+    //连接中的结果回调与超时定时器
+    std::shared_ptr<onErrCB> _async_con_cb;
+    EventPoller::DelayTask::Ptr _con_timer;
+
+    //对象个数统计
+    ObjectStatistic<Socket> _statistic;
+};
+
+} // namespace FFZKit
+
+#endif //FFZKIT_SOCKET_H
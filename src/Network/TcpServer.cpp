@@ -0,0 +1,232 @@
+//
+// Created by FFZero on 2025-06-28.
+//
+
+#include "TcpServer.h"
+#include "Util/logger.h"
+
+using namespace std;
+
+namespace FFZKit {
+
+//会话巡检间隔
+static constexpr uint64_t kManagerIntervalMs = 1000;
+
+struct TcpServer::PollerContext {
+    EventPoller::Ptr poller;
+    //本poller上的监听socket，非linux下只有第一个poller监听
+    Socket::Ptr listener;
+    EventPoller::DelayTask::Ptr timer;
+    //会话对象内存池
+    BlockPool::Ptr pool = std::make_shared<BlockPool>();
+    //本poller上的会话，只在poller线程访问
+    unordered_map<Session *, Session::Ptr> sessions;
+    //巡检时的会话快照，复用内存
+    vector<Session::Ptr> snapshot;
+
+    atomic<uint64_t> accepted { 0 };
+    atomic<uint64_t> closed { 0 };
+    atomic<uint64_t> timeout { 0 };
+    atomic<uint64_t> recv_bytes { 0 };
+    atomic<uint64_t> online { 0 };
+};
+
+TcpServer::~TcpServer() {
+    for (auto &ctx : _contexts) {
+        //在各自poller线程停止监听并关闭会话，onError随之在该线程回调
+        ctx->poller->async([ctx]() {
+            if (ctx->timer) {
+                ctx->timer->cancel();
+                ctx->timer = nullptr;
+            }
+            ctx->listener = nullptr;
+            ctx->snapshot.clear();
+            for (auto &pr : ctx->sessions) {
+                ctx->snapshot.emplace_back(pr.second);
+            }
+            for (auto &session : ctx->snapshot) {
+                session->shutdown(SockException(Err_shutdown, "tcp server shutdown"));
+            }
+            ctx->snapshot.clear();
+        }, false);
+    }
+}
+
+void TcpServer::setIdleTimeout(uint32_t second) {
+    _idle_timeout_ms = (uint64_t)second * 1000;
+}
+
+uint16_t TcpServer::getPort() const {
+    return _port;
+}
+
+TcpServer::Statistic TcpServer::getStatistic() const {
+    Statistic ret;
+    for (auto &ctx : _contexts) {
+        ret.accepted += ctx->accepted.load(memory_order_relaxed);
+        ret.closed += ctx->closed.load(memory_order_relaxed);
+        ret.timeout += ctx->timeout.load(memory_order_relaxed);
+        ret.recv_bytes += ctx->recv_bytes.load(memory_order_relaxed);
+        ret.online += ctx->online.load(memory_order_relaxed);
+    }
+    return ret;
+}
+
+bool TcpServer::start_l(uint16_t port, const string &host, int backlog, SessionAlloc alloc) {
+    if (!_contexts.empty()) {
+        //已在运行，不能修改会话类型(poller线程正在读取_session_alloc)
+        WarnL << "Tcp server already started on port " << _port;
+        return false;
+    }
+    //开始监听前设置，之后只读
+    _session_alloc = std::move(alloc);
+    EventPollerPool::Instance().for_each([&](const TaskExecutor::Ptr &executor) {
+        auto ctx = std::make_shared<PollerContext>();
+        ctx->poller = static_pointer_cast<EventPoller>(executor);
+        _contexts.emplace_back(std::move(ctx));
+    });
+
+#if defined(__linux__) || defined(__linux)
+    //每个poller各自监听同一端口，由内核把连接分散到各个监听socket
+    auto listen_count = _contexts.size();
+    bool reuse_port = true;
+#else
+    size_t listen_count = 1;
+    bool reuse_port = false;
+#endif
+
+    weak_ptr<TcpServer> weak_self = shared_from_this();
+    for (size_t i = 0; i < listen_count; ++i) {
+        auto &ctx = _contexts[i];
+        auto listener = Socket::createSocket(ctx->poller);
+        if (listen_count == 1) {
+            //新连接分配给负载最轻的poller
+            listener->setOnBeforeAccept([](const EventPoller::Ptr &) {
+                return Socket::createSocket(EventPollerPool::Instance().getPoller(false));
+            });
+        }
+        listener->setOnAccept([weak_self](Socket::Ptr &sock) {
+            auto strong_self = weak_self.lock();
+            if (!strong_self) {
+                return;
+            }
+            auto ctx = strong_self->getContext(sock->getPoller());
+            if (ctx) {
+                strong_self->onAccept(ctx, sock);
+            }
+        });
+        if (!listener->listen(port, host, backlog, reuse_port)) {
+            _contexts.clear();
+            return false;
+        }
+        if (!port) {
+            //随机端口，其余poller监听同一端口
+            port = listener->get_local_port();
+        }
+        ctx->listener = std::move(listener);
+    }
+    _port = port;
+
+    for (auto &ctx : _contexts) {
+        weak_ptr<PollerContext> weak_ctx = ctx;
+        ctx->timer = ctx->poller->doDelayTask(kManagerIntervalMs, [weak_self, weak_ctx]() -> uint64_t {
+            auto strong_self = weak_self.lock();
+            auto strong_ctx = weak_ctx.lock();
+            if (!strong_self || !strong_ctx) {
+                return 0;
+            }
+            strong_self->onManager(*strong_ctx);
+            return kManagerIntervalMs;
+        });
+    }
+    InfoL << "Tcp server listening on [" << host << "]:" << _port << " with " << listen_count << " listener(s)";
+    return true;
+}
+
+shared_ptr<TcpServer::PollerContext> TcpServer::getContext(const EventPoller::Ptr &poller) const {
+    for (auto &ctx : _contexts) {
+        if (ctx->poller == poller) {
+            return ctx;
+        }
+    }
+    return nullptr;
+}
+
+void TcpServer::onAccept(const shared_ptr<PollerContext> &ctx, Socket::Ptr &sock) {
+    Session::Ptr session;
+    try {
+        session = _session_alloc(ctx->pool, sock);
+    } catch (std::exception &ex) {
+        ErrorL << "Create session failed: " << ex.what();
+        return;
+    }
+
+    weak_ptr<Session> weak_session = session;
+    sock->setOnRead([weak_session, ctx](Buffer::Ptr &buf, struct sockaddr *, int) {
+        auto strong_session = weak_session.lock();
+        if (!strong_session) {
+            return;
+        }
+        strong_session->_last_recv_ms = getCurrentMillisecond();
+        ctx->recv_bytes.fetch_add(buf->size(), memory_order_relaxed);
+        try {
+            strong_session->onRecv(buf);
+        } catch (std::exception &ex) {
+            strong_session->shutdown(SockException(Err_other, ex.what()));
+        }
+    });
+    sock->setOnErr([weak_session, ctx](const SockException &err) {
+        auto strong_session = weak_session.lock();
+        if (!strong_session) {
+            return;
+        }
+        strong_session->_err_emit = true;
+        if (ctx->sessions.erase(strong_session.get())) {
+            ctx->online.fetch_sub(1, memory_order_relaxed);
+            ctx->closed.fetch_add(1, memory_order_relaxed);
+        }
+        try {
+            strong_session->onError(err);
+        } catch (std::exception &ex) {
+            WarnL << "Exception occurred when emit onError: " << ex.what();
+        }
+    });
+
+    //监听与会话在同一poller时同步加入；否则在会话所在poller加入，此前socket已开始监听事件，可能已先回调onErr，见addSession
+    ctx->poller->async([ctx, session]() { addSession(*ctx, session); });
+}
+
+void TcpServer::addSession(PollerContext &ctx, const Session::Ptr &session) {
+    ctx.accepted.fetch_add(1, memory_order_relaxed);
+    if (session->_err_emit) {
+        //socket已挂到会话所在poller，加入前连接已断开且onError已回调，不能再加入
+        ctx.closed.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+    ctx.sessions.emplace(session.get(), session);
+    ctx.online.fetch_add(1, memory_order_relaxed);
+}
+
+void TcpServer::onManager(PollerContext &ctx) {
+    auto timeout_ms = _idle_timeout_ms.load(memory_order_relaxed);
+    //回调中可能关闭会话并修改sessions，先做快照
+    ctx.snapshot.clear();
+    for (auto &pr : ctx.sessions) {
+        ctx.snapshot.emplace_back(pr.second);
+    }
+    for (auto &session : ctx.snapshot) {
+        if (timeout_ms && session->getIdleTime() >= timeout_ms) {
+            ctx.timeout.fetch_add(1, memory_order_relaxed);
+            session->shutdown(SockException(Err_timeout, "session idle timeout"));
+            continue;
+        }
+        try {
+            session->onManager();
+        } catch (std::exception &ex) {
+            WarnL << "Exception occurred when emit onManager: " << ex.what();
+        }
+    }
+    ctx.snapshot.clear();
+}
+
+} // namespace FFZKit
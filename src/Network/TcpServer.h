@@ -0,0 +1,188 @@
+//
+// Created by FFZero on 2025-06-28.
+//
+
+#ifndef FFZKIT_TCPSERVER_H
+#define FFZKIT_TCPSERVER_H
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <type_traits>
+#include "Network/Session.h"
+
+namespace FFZKit {
+
+/**
+ * 定长内存块缓存，用于会话对象的分配，释放的内存块缓存起来供下次分配
+ * 可在任意线程释放
+ */
+class BlockPool : public noncopyable {
+public:
+    using Ptr = std::shared_ptr<BlockPool>;
+
+    /**
+     * @param max_cached 最多缓存的内存块个数
+     */
+    BlockPool(size_t max_cached = 1024) : _max_cached(max_cached) {}
+
+    ~BlockPool() {
+        for (auto ptr : _free) {
+            ::operator delete(ptr);
+        }
+    }
+
+    void *allocate(size_t size) {
+        {
+            std::lock_guard<std::mutex> lck(_mtx);
+            if (!_block_size) {
+                // 首次分配决定内存块大小
+                _block_size = size;
+            }
+            if (size == _block_size && !_free.empty()) {
+                auto ret = _free.back();
+                _free.pop_back();
+                return ret;
+            }
+        }
+        return ::operator new(size);
+    }
+
+    void deallocate(void *ptr, size_t size) {
+        {
+            std::lock_guard<std::mutex> lck(_mtx);
+            if (size == _block_size && _free.size() < _max_cached) {
+                _free.emplace_back(ptr);
+                return;
+            }
+        }
+        ::operator delete(ptr);
+    }
+
+private:
+    size_t _max_cached;
+    size_t _block_size = 0;
+    std::mutex _mtx;
+    std::vector<void *> _free;
+};
+
+/**
+ * 基于BlockPool的分配器，配合std::allocate_shared使用，对象与引用计数在同一内存块
+ */
+template <typename T>
+class BlockAllocator {
+public:
+    using value_type = T;
+
+    BlockAllocator(BlockPool::Ptr pool) : _pool(std::move(pool)) {}
+
+    template <typename U>
+    BlockAllocator(const BlockAllocator<U> &that) : _pool(that._pool) {}
+
+    T *allocate(size_t n) {
+        return static_cast<T *>(_pool->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *ptr, size_t n) {
+        _pool->deallocate(ptr, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const BlockAllocator<U> &that) const {
+        return _pool == that._pool;
+    }
+
+    template <typename U>
+    bool operator!=(const BlockAllocator<U> &that) const {
+        return _pool != that._pool;
+    }
+
+private:
+    template <typename U>
+    friend class BlockAllocator;
+
+    BlockPool::Ptr _pool;
+};
+
+/**
+ * tcp服务器，为每个连接创建一个Session子类对象
+ * linux下每个poller各自以SO_REUSEPORT监听同一端口，连接在接受它的poller上创建会话并由该poller管理；
+ * 其他系统由一个poller监听，新连接分配给负载最轻的poller
+ * 每个poller一个巡检定时器，统一回调onManager并关闭空闲超时的会话，无需每个会话一个定时器；
+ * 会话对象的内存按poller池化复用，每个连接仍会重新构造会话对象
+ */
+class TcpServer : public std::enable_shared_from_this<TcpServer>, public noncopyable {
+public:
+    using Ptr = std::shared_ptr<TcpServer>;
+
+    //服务器统计，为所有poller的累加值
+    struct Statistic {
+        //累计接受的连接数
+        uint64_t accepted = 0;
+        //累计关闭的会话数
+        uint64_t closed = 0;
+        //其中因空闲超时关闭的会话数
+        uint64_t timeout = 0;
+        //累计接收的字节数
+        uint64_t recv_bytes = 0;
+        //当前在线会话数
+        uint64_t online = 0;
+    };
+
+    TcpServer() = default;
+    ~TcpServer();
+
+    /**
+     * 开始监听
+     * @tparam SessionType 会话类型，需继承Session
+     * @param port 监听端口，0则随机
+     * @param host 监听的网卡ip
+     * @param backlog tcp最大积压数
+     * @return 是否成功
+     */
+    template <typename SessionType>
+    bool start(uint16_t port, const std::string &host = "::", int backlog = 1024) {
+        static_assert(std::is_base_of<Session, SessionType>::value, "SessionType must inherit from Session");
+        return start_l(port, host, backlog, [](const BlockPool::Ptr &pool, const Socket::Ptr &sock) -> Session::Ptr {
+            return std::allocate_shared<SessionType>(BlockAllocator<SessionType>(pool), sock);
+        });
+    }
+
+    /**
+     * 设置会话空闲超时，收发均空闲超过该时长的会话以Err_timeout关闭
+     * @param second 超时秒数，0为不限制
+     */
+    void setIdleTimeout(uint32_t second);
+
+    /**
+     * 获取监听端口
+     */
+    uint16_t getPort() const;
+
+    /**
+     * 获取统计数据，线程安全
+     */
+    Statistic getStatistic() const;
+
+private:
+    struct PollerContext;
+    using SessionAlloc = std::function<Session::Ptr(const BlockPool::Ptr &pool, const Socket::Ptr &sock)>;
+
+    bool start_l(uint16_t port, const std::string &host, int backlog, SessionAlloc alloc);
+    std::shared_ptr<PollerContext> getContext(const EventPoller::Ptr &poller) const;
+    void onAccept(const std::shared_ptr<PollerContext> &ctx, Socket::Ptr &sock);
+    static void addSession(PollerContext &ctx, const Session::Ptr &session);
+    void onManager(PollerContext &ctx);
+
+private:
+    uint16_t _port = 0;
+    std::atomic<uint64_t> _idle_timeout_ms { 0 };
+    SessionAlloc _session_alloc;
+    std::vector<std::shared_ptr<PollerContext> > _contexts;
+};
+
+} // namespace FFZKit
+
+#endif //FFZKIT_TCPSERVER_H
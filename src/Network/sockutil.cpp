@@ -5,12 +5,16 @@
 #include <fcntl.h>
 #include <assert.h>
 #include <cstdio>
+#include <atomic>
 #include <unordered_map>
+#include <condition_variable>
+#include <signal.h>
 
 #include "sockutil.h"
 #include "Util/logger.h"
 #include "Util/uv_errno.h"
 #include "Util/onceToken.h"
+#include "Thread/ThreadPool.h"
 
 using namespace std;
 
@@ -33,6 +37,16 @@ int close(int fd) {
     return closesocket(fd);
 }
 
+#else
+
+// sendfile/splice写socket时无法指定MSG_NOSIGNAL，库加载时忽略SIGPIPE；应用已设置处理方式时保留
+static OnceToken g_token([]() {
+    struct sigaction sa;
+    if (sigaction(SIGPIPE, nullptr, &sa) == 0 && !(sa.sa_flags & SA_SIGINFO) && sa.sa_handler == SIG_DFL) {
+        signal(SIGPIPE, SIG_IGN);
+    }
+});
+
 #endif // defined(_WIN32)
 
 
@@ -117,6 +131,45 @@ int SockUtil::setNoDelay(int fd, bool on) {
     return ret;
 }
 
+int SockUtil::setUdpSegment(int fd, uint16_t segment_size) {
+#if defined(__linux__) || defined(__linux)
+    int opt = segment_size;
+    int ret = setsockopt(fd, SOL_UDP, UDP_SEGMENT, (char *) &opt, static_cast<socklen_t>(sizeof(opt)));
+    if (ret == -1) {
+        WarnL << "setsockopt UDP_SEGMENT failed";
+    }
+    return ret;
+#else
+    return -1;
+#endif
+}
+
+int SockUtil::setUdpGro(int fd, bool on) {
+#if defined(__linux__) || defined(__linux)
+    int opt = on ? 1 : 0;
+    int ret = setsockopt(fd, SOL_UDP, UDP_GRO, (char *) &opt, static_cast<socklen_t>(sizeof(opt)));
+    if (ret == -1) {
+        WarnL << "setsockopt UDP_GRO failed";
+    }
+    return ret;
+#else
+    return -1;
+#endif
+}
+
+int SockUtil::setZeroCopy(int fd, bool on) {
+#if defined(__linux__) || defined(__linux)
+    int opt = on ? 1 : 0;
+    int ret = setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, (char *) &opt, static_cast<socklen_t>(sizeof(opt)));
+    if (ret == -1) {
+        WarnL << "setsockopt SO_ZEROCOPY failed";
+    }
+    return ret;
+#else
+    return -1;
+#endif
+}
+
 int SockUtil::setReuseable(int fd, bool on, bool reuse_port) {
     int opt = on ? 1 : 0;
     int ret = setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (char *) &opt, static_cast<socklen_t>(sizeof(opt)));
@@ -287,6 +340,11 @@ struct sockaddr_storage SockUtil::make_sockaddr(const char *host, uint16_t port)
     throw std::invalid_argument(string("Not ip address: ") + host);
 }
 
+//dns缓存分片数，降低多线程并发解析时的锁竞争
+static constexpr size_t kDnsShardCount = 16;
+//解析失败结果的缓存时间，避免失效域名每次连接都同步解析
+static constexpr uint64_t kDnsNegativeExpireMs = 10 * 1000;
+
 class DnsCache {
 public:
     static DnsCache& Instance() {
@@ -294,58 +352,190 @@ public:
         return s_instance;
     }
 
-    bool getDomainIP(const char *host, struct sockaddr_storage &storage, int ai_family = AF_INET,
-                         int ai_socktype = SOCK_STREAM, int ai_protocol = IPPROTO_TCP, int expire_sec = 60) {
-
-        try {
+    /**
+     * 有效期过3/4后在后台刷新(刷新失败后退避kDnsNegativeExpireMs)，过期后一个有效期内仍返回旧结果并刷新
+     * 同一域名并发未命中时只同步解析一次，其他线程等待其结果
+     * @param cache_only 只查询缓存，未命中时不解析
+     */
+    bool getDomainIP(const char *host, struct sockaddr_storage &storage, int ai_family, int ai_socktype,
+                     int ai_protocol, int expire_sec, bool cache_only) {
+        if (SockUtil::is_ipv4(host) || SockUtil::is_ipv6(host)) {
             storage = SockUtil::make_sockaddr(host, 0);
             return true;
-        } catch(...) {
-            InfoL << "Not ip address: " << host << ", try to resolve it";
-            auto item = getCacheDomainIP(host, expire_sec);
-            if(!item) {
-                item = getSystemDomainIP(host);
-                if(item) {
-                    setCacheDomainIP(host, item);
+        }
+
+        //查询时不拷贝域名，只在首次缓存该域名时保存一份
+        auto key = makeKey(host);
+        auto &shard = shards_[key.hash % kDnsShardCount];
+        auto expire_ms = (uint64_t)expire_sec * 1000;
+        std::shared_ptr<struct addrinfo> addr_info;
+        bool need_refresh = false;
+        //缓存项创建后不会删除，解锁后仍可使用
+        DnsItem *item = nullptr;
+        {
+            unique_lock<mutex> lock(shard.mtx);
+            auto it = shard.items.find(key);
+            if (it != shard.items.end()) {
+                item = it->second.get();
+            }
+            //同一域名同时只由一个线程同步解析，其他线程等待其结果
+            while (!cache_only && item && item->resolving) {
+                shard.cond.wait(lock);
+            }
+            if (item) {
+                auto now = getCurrentMillisecond();
+                auto age = now - item->create_time;
+                if (item->addr_info && age < expire_ms * 2) {
+                    addr_info = item->addr_info;
+                    ++(age < expire_ms ? hit_ : stale_hit_);
+                    if (age >= expire_ms * 3 / 4 && !item->refreshing && now >= item->retry_time) {
+                        item->refreshing = true;
+                        need_refresh = true;
+                    }
+                } else if (item->fail_time && now - item->fail_time < kDnsNegativeExpireMs) {
+                    if (!cache_only) {
+                        ++negative_hit_;
+                    }
+                    return false;
                 }
             }
+            if (!addr_info) {
+                if (cache_only) {
+                    return false;
+                }
+                ++miss_;
+                if (!item) {
+                    item = addItem(shard, key);
+                }
+                item->resolving = true;
+            }
+        }
 
-            if(item) {
-                auto addr = getPreferredAddress(item.get(), ai_family, ai_socktype, ai_protocol);
-                memcpy(&storage, addr->ai_addr, addr->ai_addrlen);
+        if (need_refresh) {
+            refresh(shard, *item);
+        }
+        if (!addr_info) {
+            addr_info = getSystemDomainIP(host);
+            setCacheDomainIP(shard, *item, addr_info);
+            if (!addr_info) {
+                return false;
             }
-            return (bool)item;
         }
+        auto addr = getPreferredAddress(addr_info.get(), ai_family, ai_socktype, ai_protocol);
+        memcpy(&storage, addr->ai_addr, addr->ai_addrlen);
+        return true;
+    }
+
+    SockUtil::DnsStatistic getStatistic() const {
+        SockUtil::DnsStatistic ret;
+        ret.hit = hit_.load();
+        ret.stale_hit = stale_hit_.load();
+        ret.negative_hit = negative_hit_.load();
+        ret.miss = miss_.load();
+        ret.refresh = refresh_.load();
+        return ret;
     }
 
 private:
     class DnsItem {
     public:
+        //域名，缓存项的key引用其内容
+        string host;
+        //最近一次成功解析的结果及时间
         std::shared_ptr<struct addrinfo> addr_info;
-        time_t create_time;
+        uint64_t create_time = 0;
+        //最近一次解析失败的时间，0代表未失败；旧结果不可再用时在kDnsNegativeExpireMs内直接返回失败
+        uint64_t fail_time = 0;
+        //后台刷新失败后，在此时间之前不再刷新
+        uint64_t retry_time = 0;
+        //是否正在后台刷新
+        bool refreshing = false;
+        //是否有线程正在同步解析
+        bool resolving = false;
     };
 
-    std::shared_ptr<struct addrinfo> getCacheDomainIP(const char* host, int expireSec) {
-        lock_guard<mutex> lock(mtx_);
-        auto it = dns_cache_.find(host);
-        if(it == dns_cache_.end()) {
-            return nullptr;
+    //域名的引用及其哈希值，查询时直接引用参数，缓存时引用DnsItem::host
+    class DnsKey {
+    public:
+        const char *host;
+        size_t size;
+        size_t hash;
+    };
+
+    struct DnsKeyHash {
+        size_t operator()(const DnsKey &key) const {
+            return key.hash;
         }
+    };
 
-        if(it->second.create_time + expireSec < time(nullptr)) {
-            // 缓存过期
-            dns_cache_.erase(it);
-            return nullptr;
-        }   
-        return it->second.addr_info;
+    struct DnsKeyEqual {
+        bool operator()(const DnsKey &a, const DnsKey &b) const {
+            return a.size == b.size && memcmp(a.host, b.host, a.size) == 0;
+        }
+    };
+
+    struct Shard {
+        mutex mtx;
+        //同步解析完成时通知等待同一域名结果的线程
+        condition_variable cond;
+        unordered_map<DnsKey, std::unique_ptr<DnsItem>, DnsKeyHash, DnsKeyEqual> items;
+    };
+
+    //FNV-1a，一次遍历同时得到长度与哈希值
+    static DnsKey makeKey(const char *host) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        auto ptr = host;
+        for (; *ptr; ++ptr) {
+            hash = (hash ^ (uint8_t)*ptr) * 0x100000001b3ULL;
+        }
+        return DnsKey { host, (size_t)(ptr - host), (size_t)hash };
+    }
+
+    //加锁后调用
+    static DnsItem *addItem(Shard &shard, const DnsKey &key) {
+        std::unique_ptr<DnsItem> item(new DnsItem);
+        item->host.assign(key.host, key.size);
+        auto ret = item.get();
+        shard.items.emplace(DnsKey { ret->host.data(), key.size, key.hash }, std::move(item));
+        return ret;
+    }
+
+    void setCacheDomainIP(Shard &shard, DnsItem &item, std::shared_ptr<struct addrinfo> addr_info) {
+        {
+            lock_guard<mutex> lock(shard.mtx);
+            item.resolving = false;
+            if (addr_info) {
+                item.addr_info = std::move(addr_info);
+                item.create_time = getCurrentMillisecond();
+                item.fail_time = 0;
+                item.retry_time = 0;
+            } else {
+                item.fail_time = getCurrentMillisecond();
+            }
+        }
+        shard.cond.notify_all();
     }
 
-    void setCacheDomainIP(const char* host, std::shared_ptr<struct addrinfo> addr_info) {
-        lock_guard<mutex> lock(mtx_);
-        DnsItem item; 
-        item.addr_info = addr_info;
-        item.create_time = time(nullptr);
-        dns_cache_[host] = std::move(item);
+    void refresh(Shard &shard, DnsItem &item) {
+        //刷新线程在首次使用时创建，先于DnsCache析构
+        static ThreadPool s_refresher(1, ThreadPool::PRIORITY_LOWEST, true, false, "dns_refresh");
+        s_refresher.async([this, &shard, &item]() {
+            //host创建后不再修改，无需加锁
+            auto addr_info = getSystemDomainIP(item.host.data());
+            ++refresh_;
+            lock_guard<mutex> lock(shard.mtx);
+            item.refreshing = false;
+            if (addr_info) {
+                item.addr_info = std::move(addr_info);
+                item.create_time = getCurrentMillisecond();
+                item.fail_time = 0;
+                item.retry_time = 0;
+            } else {
+                //刷新失败时保留旧结果直到其不可再用，并记录失败结果；退避一段时间后再刷新
+                item.fail_time = getCurrentMillisecond();
+                item.retry_time = item.fail_time + kDnsNegativeExpireMs;
+            }
+        });
     }
 
     std::shared_ptr<struct addrinfo> getSystemDomainIP(const char *host) {
@@ -375,30 +565,50 @@ private:
     }
 
 private:
-    mutex mtx_;
-    unordered_map<string, DnsItem> dns_cache_;
+    Shard shards_[kDnsShardCount];
+    atomic<uint64_t> hit_ { 0 };
+    atomic<uint64_t> stale_hit_ { 0 };
+    atomic<uint64_t> negative_hit_ { 0 };
+    atomic<uint64_t> miss_ { 0 };
+    atomic<uint64_t> refresh_ { 0 };
 };
 
+void SockUtil::set_sockaddr_port(struct sockaddr_storage &addr, uint16_t port) {
+    switch (addr.ss_family) {
+        case AF_INET:
+            ((sockaddr_in *) &addr)->sin_port = htons(port);
+            break;
+        case AF_INET6:
+            ((sockaddr_in6 *) &addr)->sin6_port = htons(port);
+            break;
+        default:
+            WarnL << "unknown family: " << addr.ss_family;
+            break;
+    }
+}
+
 bool SockUtil::getDomainIP(const char *host, uint16_t port, struct sockaddr_storage &addr, int ai_family,
                             int ai_socktype, int ai_protocol, int expire_sec) {
+    bool flag = DnsCache::Instance().getDomainIP(host, addr, ai_family, ai_socktype, ai_protocol, expire_sec, false);
+    if (flag) {
+        set_sockaddr_port(addr, port);
+    }
+    return flag;
+}
 
-    bool flag = DnsCache::Instance().getDomainIP(host, addr, ai_family, ai_socktype, ai_protocol, expire_sec);     
-    if(flag) {
-        switch (addr.ss_family ) {
-            case AF_INET: 
-                ((sockaddr_in*) &addr)->sin_port = htons(port);
-                break;
-            case AF_INET6:
-                ((sockaddr_in6*) &addr)->sin6_port = htons(port);
-                break;
-            default: 
-                WarnL << "unknown family: " << addr.ss_family;
-                break;
-        }
-    }                       
+bool SockUtil::getDomainIPFromCache(const char *host, uint16_t port, struct sockaddr_storage &addr, int ai_family,
+                                    int ai_socktype, int ai_protocol, int expire_sec) {
+    bool flag = DnsCache::Instance().getDomainIP(host, addr, ai_family, ai_socktype, ai_protocol, expire_sec, true);
+    if (flag) {
+        set_sockaddr_port(addr, port);
+    }
     return flag;
 }
 
+SockUtil::DnsStatistic SockUtil::getDnsStatistic() {
+    return DnsCache::Instance().getStatistic();
+}
+
 static int set_ipv6_only(int fd, bool flag) {
     int opt = flag; 
     int ret = setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, (const char*)&opt, sizeof opt);
@@ -505,7 +715,7 @@ int SockUtil::connect(const char *host, uint16_t port, bool async, const char *l
 }
 
 
-int SockUtil::listen(const uint16_t port, const char *local_ip, int back_log) {
+int SockUtil::listen(const uint16_t port, const char *local_ip, int back_log, bool reuse_port) {
     int fd = -1;
     int family = support_ipv6() ? (is_ipv4(local_ip) ? AF_INET : AF_INET6) : AF_INET;
     if ((fd = (int)::socket(family, SOCK_STREAM, IPPROTO_TCP)) == -1) {
@@ -513,7 +723,7 @@ int SockUtil::listen(const uint16_t port, const char *local_ip, int back_log) {
         return -1;
     }
 
-    setReuseable(fd, true, false);
+    setReuseable(fd, true, reuse_port);
     setNoBlocked(fd);
     setCloExec(fd);
 
@@ -19,8 +19,25 @@
     #include <net/if.h>
     #include <netinet/in.h>
     #include <netinet/tcp.h>
+    #include <netinet/udp.h>
 #endif // defined(_WIN32)
 
+#if defined(__linux__) || defined(__linux)
+    // 旧版本glibc未定义udp分段卸载、零拷贝相关选项
+    #if !defined(SOL_UDP)
+    #define SOL_UDP 17
+    #endif
+    #if !defined(UDP_SEGMENT)
+    #define UDP_SEGMENT 103
+    #endif
+    #if !defined(UDP_GRO)
+    #define UDP_GRO 104
+    #endif
+    #if !defined(SO_ZEROCOPY)
+    #define SO_ZEROCOPY 60
+    #endif
+#endif
+
 #include <cstring>
 #include <cstdint>
 #include <map>
@@ -72,9 +89,10 @@ public:
      * @param port 监听的本地端口
      * @param local_ip 绑定的本地网卡ip
      * @param back_log accept列队长度
+     * @param reuse_port 是否开启SO_REUSEPORT，多个套接字监听同一端口，由内核分配连接
      * @return -1代表失败，其他为socket fd号
      */
-    static int listen(const uint16_t port, const char *local_ip = "::", int back_log = 1024);
+    static int listen(const uint16_t port, const char *local_ip = "::", int back_log = 1024, bool reuse_port = false);
 
     /**
      * 创建udp套接字
@@ -131,6 +149,32 @@ public:
 
     static int setBroadcast(int fd, bool on = true);
 
+    /**
+     * 设置udp发送分段卸载(UDP_SEGMENT，仅linux)
+     * 开启后一次发送的大数据报由内核(或网卡)切分为多个segment_size大小的数据报(最后一个可以更小)
+     * @param fd socket fd号
+     * @param segment_size 分段大小，0为关闭
+     * @return 0代表成功，-1为失败(系统不支持)
+     */
+    static int setUdpSegment(int fd, uint16_t segment_size);
+
+    /**
+     * 开启udp接收合并(UDP_GRO，仅linux)
+     * 开启后同一来源连续的同尺寸数据报可能被合并为一次读取，分段大小通过UDP_GRO cmsg获取
+     * @param fd socket fd号
+     * @param on 是否开启
+     * @return 0代表成功，-1为失败(系统不支持)
+     */
+    static int setUdpGro(int fd, bool on = true);
+
+    /**
+     * 开启SO_ZEROCOPY(仅linux)，开启后才能以MSG_ZEROCOPY发送数据
+     * @param fd socket fd号
+     * @param on 是否开启
+     * @return 0代表成功，-1为失败(系统不支持)
+     */
+    static int setZeroCopy(int fd, bool on = true);
+
     /**
      * 是否开启TCP KeepAlive特性
      * @param fd socket fd号
@@ -171,6 +215,32 @@ public:
     static bool getDomainIP(const char *host, uint16_t port, struct sockaddr_storage &addr, int ai_family = AF_INET,
                             int ai_socktype = SOCK_STREAM, int ai_protocol = IPPROTO_TCP, int expire_sec = 60);
 
+    /**
+     * 只从dns缓存获取域名地址，不会阻塞
+     * @return ip地址或者缓存命中(包括过期后仍可使用的旧结果)时返回true
+     */
+    static bool getDomainIPFromCache(const char *host, uint16_t port, struct sockaddr_storage &addr, int ai_family = AF_INET,
+                                     int ai_socktype = SOCK_STREAM, int ai_protocol = IPPROTO_TCP, int expire_sec = 60);
+
+    //dns缓存统计
+    struct DnsStatistic {
+        //有效期内命中
+        uint64_t hit = 0;
+        //过期后返回旧结果，同时后台刷新
+        uint64_t stale_hit = 0;
+        //命中解析失败的缓存
+        uint64_t negative_hit = 0;
+        //未命中，同步解析
+        uint64_t miss = 0;
+        //后台刷新次数
+        uint64_t refresh = 0;
+    };
+
+    /**
+     * 获取dns缓存统计，线程安全
+     */
+    static DnsStatistic getDnsStatistic();
+
     /**
     * 获取该socket当前发生的错误
     * @param fd socket fd号
@@ -210,6 +280,11 @@ public:
 
     static uint16_t inet_port(const struct sockaddr *addr);
 
+    /**
+     * 设置ipv4/ipv6地址的端口，其他地址族忽略
+     */
+    static void set_sockaddr_port(struct sockaddr_storage &addr, uint16_t port);
+
     static struct sockaddr_storage make_sockaddr(const char *host, uint16_t port);
 
     static socklen_t get_sock_len(const struct sockaddr *addr);
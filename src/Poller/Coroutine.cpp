@@ -0,0 +1,143 @@
+//
+// Created by FFZero on 2025-03-02.
+//
+
+#include "Coroutine.h"
+
+#if defined(ENABLE_COROUTINE)
+
+#include <vector>
+
+using namespace std;
+
+namespace FFZKit {
+
+// 帧大小按64字节分档，最大缓存2K的帧
+static constexpr size_t kFrameAlign = 64;
+static constexpr size_t kFrameSlots = 32;
+// 每个档位最多缓存的空闲块个数
+static constexpr size_t kFrameMaxFree = 256;
+
+// 本线程的内存池是否已随线程退出而析构，此后分配和释放直接走系统
+static thread_local bool s_pool_destroyed = false;
+
+class CoFramePoolImp {
+public:
+    ~CoFramePoolImp() {
+        s_pool_destroyed = true;
+        for (auto &slot : free_list_) {
+            for (auto ptr : slot) {
+                ::operator delete(ptr);
+            }
+        }
+    }
+
+    void *alloc(size_t size) {
+        auto index = slotIndex(size);
+        if (index >= kFrameSlots) {
+            return ::operator new(size);
+        }
+        auto &slot = free_list_[index];
+        if (slot.empty()) {
+            return ::operator new((index + 1) * kFrameAlign);
+        }
+        auto ptr = slot.back();
+        slot.pop_back();
+        return ptr;
+    }
+
+    void free(void *ptr, size_t size) {
+        auto index = slotIndex(size);
+        // 其他线程创建的帧也可能在这里释放，每档的缓存个数有上限，不会因单向迁移无限增长
+        if (index >= kFrameSlots || free_list_[index].size() >= kFrameMaxFree) {
+            ::operator delete(ptr);
+            return;
+        }
+        free_list_[index].emplace_back(ptr);
+    }
+
+    size_t freeCount() const {
+        size_t ret = 0;
+        for (auto &slot : free_list_) {
+            ret += slot.size();
+        }
+        return ret;
+    }
+
+private:
+    static size_t slotIndex(size_t size) {
+        return (size + kFrameAlign - 1) / kFrameAlign - 1;
+    }
+
+private:
+    vector<void *> free_list_[kFrameSlots];
+};
+
+static CoFramePoolImp &getFramePool() {
+    // 协程帧可能在任意线程创建(调用协程函数的线程)，并在协程结束时所在的线程销毁，
+    // 所以帧会在各线程的内存池之间迁移；块大小只取决于档位，归还到哪个线程的内存池都可以
+    static thread_local CoFramePoolImp s_pool;
+    return s_pool;
+}
+
+void *CoFramePool::alloc(size_t size) {
+    if (s_pool_destroyed) {
+        // 按档位大小分配，该块之后可能归还到其他线程的内存池中复用
+        return ::operator new((size + kFrameAlign - 1) / kFrameAlign * kFrameAlign);
+    }
+    return getFramePool().alloc(size);
+}
+
+void CoFramePool::free(void *ptr, size_t size) {
+    if (s_pool_destroyed) {
+        ::operator delete(ptr);
+        return;
+    }
+    getFramePool().free(ptr, size);
+}
+
+size_t CoFramePool::freeCount() {
+    return s_pool_destroyed ? 0 : getFramePool().freeCount();
+}
+
+static EventPoller::Ptr getResumePoller() {
+    auto poller = EventPoller::getCurrentPoller();
+    if (!poller) {
+        poller = EventPollerPool::Instance().getPoller();
+    }
+    return poller;
+}
+
+void CoDelayAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    getResumePoller()->doDelayTask(delay_ms_, [handle]() -> uint64_t {
+        handle.resume();
+        return 0;
+    });
+}
+
+bool CoEventAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    auto poller = getResumePoller();
+    if (!poller->isCurrentThread()) {
+        // 先切换到poller线程，保证事件监听和回调在同一线程
+        poller->async([this, handle, poller]() {
+            if (!await_suspend(handle)) {
+                handle.resume();
+            }
+        }, false);
+        return true;
+    }
+
+    auto fd = fd_;
+    auto ret = poller->addEvent(fd, event_, [this, handle, poller, fd](int event) {
+        // 一次性监听，恢复协程前先移除
+        poller->delEvent(fd);
+        result_ = event;
+        handle.resume();
+    });
+    // 监听失败时不挂起，返回-1
+    return ret != -1;
+}
+
+} // namespace FFZKit
+
+#endif // defined(ENABLE_COROUTINE)
@@ -0,0 +1,261 @@
+//
+// Created by FFZero on 2025-03-02.
+//
+
+#ifndef FFZKIT_COROUTINE_H
+#define FFZKIT_COROUTINE_H
+
+#if defined(ENABLE_COROUTINE)
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+#include "EventPoller.h"
+
+namespace FFZKit {
+
+/**
+ * 协程帧内存池，按线程隔离，无需加锁
+ * 协程帧在调用协程函数的线程上创建，在协程结束时所在的线程上销毁，两者可以不同(例如co_await poller切换过线程)
+ * 空闲块归还到销毁线程的内存池，因为每个块都是按档位大小单独分配的，任何线程的内存池都可以复用
+ * 帧大小按64字节对齐分档，超出最大档位的帧直接走系统分配
+ */
+class CoFramePool {
+public:
+    static void *alloc(size_t size);
+    static void free(void *ptr, size_t size);
+
+    /**
+     * 当前线程内存池缓存的空闲块个数
+     */
+    static size_t freeCount();
+};
+
+class CoPromiseBase {
+public:
+    static void *operator new(size_t size) {
+        return CoFramePool::alloc(size);
+    }
+
+    static void operator delete(void *ptr, size_t size) {
+        CoFramePool::free(ptr, size);
+    }
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    void unhandled_exception() noexcept {
+        exception_ = std::current_exception();
+    }
+
+    void rethrowIfNeed() {
+        if (exception_) {
+            std::rethrow_exception(exception_);
+        }
+    }
+
+    // 等待本协程结束的协程
+    std::coroutine_handle<> continuation_;
+    // 是否已经分离，分离后协程结束时自行销毁帧
+    bool detached_ = false;
+    std::exception_ptr exception_;
+};
+
+template<typename T>
+class CoPromiseValue : public CoPromiseBase {
+public:
+    template<typename V>
+    void return_value(V &&value) {
+        value_ = std::forward<V>(value);
+    }
+
+    T result() {
+        rethrowIfNeed();
+        return std::move(value_);
+    }
+
+private:
+    T value_ {};
+};
+
+template<>
+class CoPromiseValue<void> : public CoPromiseBase {
+public:
+    void return_void() {}
+
+    void result() {
+        rethrowIfNeed();
+    }
+};
+
+/**
+ * 协程任务，创建后不会立即执行(lazy)
+ * 1、在其他协程中 co_await 该任务，执行完毕后返回结果
+ * 2、调用start()分离执行，协程结束后自动释放
+ */
+template<typename T = void>
+class CoTask : public noncopyable {
+public:
+    class promise_type : public CoPromiseValue<T> {
+    public:
+        CoTask get_return_object() {
+            return CoTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        auto final_suspend() noexcept {
+            class FinalAwaiter {
+            public:
+                bool await_ready() noexcept { return false; }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                    auto &promise = handle.promise();
+                    if (promise.continuation_) {
+                        return promise.continuation_;
+                    }
+                    if (promise.detached_) {
+                        if (promise.exception_) {
+                            try {
+                                std::rethrow_exception(promise.exception_);
+                            } catch (std::exception &ex) {
+                                ErrorL << "Exception occurred in detached coroutine: " << ex.what();
+                            } catch (...) {
+                                ErrorL << "Unknown exception occurred in detached coroutine";
+                            }
+                        }
+                        handle.destroy();
+                    }
+                    return std::noop_coroutine();
+                }
+
+                void await_resume() noexcept {}
+            };
+            return FinalAwaiter();
+        }
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    CoTask(CoTask &&that) noexcept : handle_(std::exchange(that.handle_, nullptr)) {}
+
+    ~CoTask() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    /**
+     * 分离执行本协程(在当前线程开始执行)，协程结束后自行释放
+     */
+    void start() {
+        auto handle = std::exchange(handle_, nullptr);
+        if (handle) {
+            handle.promise().detached_ = true;
+            handle.resume();
+        }
+    }
+
+    bool await_ready() const noexcept {
+        return !handle_ || handle_.done();
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept {
+        handle_.promise().continuation_ = continuation;
+        return handle_;
+    }
+
+    T await_resume() {
+        return handle_.promise().result();
+    }
+
+private:
+    explicit CoTask(Handle handle) : handle_(handle) {}
+
+private:
+    Handle handle_;
+};
+
+/**
+ * co_await poller; 切换到该poller线程继续执行
+ */
+class CoSwitchAwaiter {
+public:
+    explicit CoSwitchAwaiter(EventPoller::Ptr poller) : poller_(std::move(poller)) {}
+
+    bool await_ready() const {
+        return poller_->isCurrentThread();
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        poller_->async([handle]() { handle.resume(); }, false);
+    }
+
+    void await_resume() const {}
+
+private:
+    EventPoller::Ptr poller_;
+};
+
+inline CoSwitchAwaiter operator co_await(const EventPoller::Ptr &poller) {
+    return CoSwitchAwaiter(poller);
+}
+
+inline CoSwitchAwaiter operator co_await(EventPoller &poller) {
+    return CoSwitchAwaiter(poller.shared_from_this());
+}
+
+/**
+ * co_await delay(ms); 基于doDelayTask的休眠，在当前poller线程恢复执行
+ */
+class CoDelayAwaiter {
+public:
+    explicit CoDelayAwaiter(uint64_t delay_ms) : delay_ms_(delay_ms) {}
+
+    bool await_ready() const { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle);
+
+    void await_resume() const {}
+
+private:
+    uint64_t delay_ms_;
+};
+
+inline CoDelayAwaiter delay(uint64_t delay_ms) {
+    return CoDelayAwaiter(delay_ms);
+}
+
+/**
+ * co_await readable(fd) / writable(fd); 基于addEvent的一次性事件监听
+ * 事件触发后立即delEvent，所以该fd不能已经被poller监听
+ * @return 触发的事件，监听失败时返回-1
+ */
+class CoEventAwaiter {
+public:
+    CoEventAwaiter(int fd, int event) : fd_(fd), event_(event) {}
+
+    bool await_ready() const { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle);
+
+    int await_resume() const {
+        return result_;
+    }
+
+private:
+    int fd_;
+    int event_;
+    int result_ = -1;
+};
+
+inline CoEventAwaiter readable(int fd) {
+    return CoEventAwaiter(fd, EventPoller::Event_Read | EventPoller::Event_Error);
+}
+
+inline CoEventAwaiter writable(int fd) {
+    return CoEventAwaiter(fd, EventPoller::Event_Write | EventPoller::Event_Error);
+}
+
+} // namespace FFZKit
+
+#endif // defined(ENABLE_COROUTINE)
+#endif //FFZKIT_COROUTINE_H
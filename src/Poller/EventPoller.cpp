@@ -7,8 +7,10 @@
 #include "SelectWrap.h"
 #include "Util/util.h"
 #include "Util/TimeTicker.h"
+#include "Util/onceToken.h"
 #include "Util/uv_errno.h"
 #include "Network/sockutil.h"
+#include "Network/BufferSock.h"
 
 #if defined(HAS_EPOLL)
 #include <sys/epoll.h>
@@ -47,6 +49,33 @@ namespace FFZKit {
 
 static thread_local std::weak_ptr<EventPoller> s_current_poller;
 
+// 标记poller线程正在执行的回调或任务，支持嵌套(例如管道事件回调中执行异步任务)
+class EventPoller::BusyScope {
+public:
+    BusyScope(EventPoller &poller, const char *label, int fd = -1) : _poller(poller) {
+        _since = poller.busy_since_.load(memory_order_relaxed);
+        _label = poller.busy_label_.load(memory_order_relaxed);
+        _fd = poller.busy_fd_.load(memory_order_relaxed);
+        poller.busy_label_.store(label, memory_order_relaxed);
+        poller.busy_fd_.store(fd, memory_order_relaxed);
+        // 流逝时间戳从程序启动时的0开始计时，而0表示空闲
+        auto now = getCurrentMillisecond();
+        poller.busy_since_.store(now ? now : 1, memory_order_release);
+    }
+
+    ~BusyScope() {
+        _poller.busy_since_.store(_since, memory_order_release);
+        _poller.busy_label_.store(_label, memory_order_relaxed);
+        _poller.busy_fd_.store(_fd, memory_order_relaxed);
+    }
+
+private:
+    EventPoller &_poller;
+    uint64_t _since;
+    const char *_label;
+    int _fd;
+};
+
 void EventPoller::addEventPipe() {
     SockUtil::setNoBlocked(pipe_.readFD());
     // 对于唤醒机制来说，写入失败是可以接受的
@@ -61,7 +90,7 @@ void EventPoller::addEventPipe() {
 }
 
 EventPoller::EventPoller(string name) {
-#if defined(HAS_EPOLL) || defined(HAS_KQUEUE)
+#if defined(HAS_EPOLL)
     event_fd_ = create_event();
     if (event_fd_ == INVALID_EVENT_FD) {
         throw runtime_error(StrPrinter << "Create event fd failed: " << get_uv_errmsg());
@@ -93,6 +122,15 @@ const string& EventPoller::getThreadName() const {
     return name_;
 }
 
+EventPoller::LoopState EventPoller::getLoopState() const {
+    LoopState state;
+    state.iteration = loop_iteration_.load(memory_order_relaxed);
+    state.busy_since = busy_since_.load(memory_order_acquire);
+    state.label = busy_label_.load(memory_order_relaxed);
+    state.fd = busy_fd_.load(memory_order_relaxed);
+    return state;
+}
+
 void EventPoller::shutdown() {
     async_I([this]() {
         throw ExitException();
@@ -112,13 +150,17 @@ void EventPoller::shutdown() {
 EventPoller::~EventPoller() {
     shutdown();
 
-#if defined(HAS_EPOLL) || defined(HAS_KQUEUE)
+#if defined(HAS_EPOLL)
     if (event_fd_ != INVALID_EVENT_FD) {
         close_event(event_fd_);
         event_fd_ = INVALID_EVENT_FD;
     }
 #endif // HAS_EPOLL
 
+#if defined(HAS_EPOLL)
+    // 执行其他线程删除监听时的完成回调(通常在其中关闭fd)
+    mergeEventOp(true);
+#endif // HAS_EPOLL
     onPipeEvent(true);
     InfoL << getThreadName() << " destroyed!";
 }
@@ -136,15 +178,35 @@ void EventPoller::runLoop(bool blocked, bool ref_self) {
         struct epoll_event events[EPOLL_SIZE];
         while (!exit_flag_) {
             minDelay = getMinDelay();
+            if (!list_pending_.empty() || !ready_list_.empty()) {
+                // 有被推迟的任务或者还有数据待处理的fd，只收集已就绪的事件，不休眠
+                minDelay = 0;
+            }
+            minDelay = checkIdleTask(minDelay);
+            // 批量修改模式下，等待前统一修改监听事件
+            flushModifyEvent();
             startSleep(); // 用于统计当前线程负载情况
             int nfds = epoll_wait(event_fd_, events, EPOLL_SIZE, minDelay);
             sleepWakeUp(); // 结束统计当前线程负载情况
+            loop_iteration_.store(loop_iteration_.load(memory_order_relaxed) + 1, memory_order_relaxed);
+            task_drained_ = false;
+            if (idle_probe_) {
+                idle_probe_ = false;
+                if (nfds == 0) {
+                    runIdleTask();
+                }
+            }
+            // 上次循环遗留的就绪fd，在处理完本次的事件后再回调
+            ready_swap_.swap(ready_list_);
             if (nfds < 0) {
+                onReadyList();
                 // Timed out or interrupted
                 continue;
             }
             
             event_cache_expired_.clear();
+            // 合并其他线程注册或删除的事件监听
+            mergeEventOp();
             for(int i = 0; i < nfds; ++i) {
                 struct epoll_event &ev = events[i];
                 int fd = ev.data.fd;
@@ -154,21 +216,32 @@ void EventPoller::runLoop(bool blocked, bool ref_self) {
                 }
 
                 auto it = event_map_.find(fd);
-                if(it == event_map_.end()) {
+                if (it == event_map_.end()) {
+                    // 可能是其他线程刚注册的fd，强制合并后再查找
+                    mergeEventOp(true);
+                    it = event_map_.find(fd);
+                }
+                if(it == event_map_.end() || event_cache_expired_.count(fd)) {
                     // 该fd已经被删除
-                    epoll_ctl(event_fd_, EPOLL_CTL_DEL, fd, nullptr);
+                    if (it == event_map_.end()) {
+                        epoll_ctl(event_fd_, EPOLL_CTL_DEL, fd, nullptr);
+                    }
                     continue;
                 }
                 auto cb = it->second;
                 try {
+                    BusyScope scope(*this, "fd event", fd);
                     (*cb)(toPoller(ev.events));
                 } catch (std::exception &ex) {
                     ErrorL << "Exception occurred when do event task: " << ex.what();
                 }
             }
+            onReadyList();
+            if (!task_drained_ && !list_pending_.empty()) {
+                // 本次循环没有管道事件，继续执行上次被推迟的任务
+                drainTask();
+            }
         }
-#elif defined(HAS_KQUEUE)
-
 #else 
         int ret, max_fd;
         FdSet set_read, set_write, set_err;
@@ -177,6 +250,11 @@ void EventPoller::runLoop(bool blocked, bool ref_self) {
 
         while (!exit_flag_) {
             minDelay = getMinDelay();
+            if (!list_pending_.empty() || !ready_list_.empty()) {
+                // 有被推迟的任务或者还有数据待处理的fd，只收集已就绪的事件，不休眠
+                minDelay = 0;
+            }
+            minDelay = checkIdleTask(minDelay);
             tv.tv_sec = (decltype(tv.tv_sec))(minDelay / 1000);
             tv.tv_usec = 1000 * (minDelay % 1000);
 
@@ -205,8 +283,19 @@ void EventPoller::runLoop(bool blocked, bool ref_self) {
             startSleep();
             ret = fz_select(max_fd + 1, &set_read, &set_write, &set_err, minDelay == -1 ? nullptr : &tv);
             sleepWakeUp();
+            loop_iteration_.store(loop_iteration_.load(memory_order_relaxed) + 1, memory_order_relaxed);
+            task_drained_ = false;
+            if (idle_probe_) {
+                idle_probe_ = false;
+                if (ret == 0) {
+                    runIdleTask();
+                }
+            }
+            // 上次循环遗留的就绪fd，在处理完本次的事件后再回调
+            ready_swap_.swap(ready_list_);
 
             if (ret < 0) {
+                onReadyList();
                 // Timed out or interrupted
                 continue;
             }
@@ -239,12 +328,18 @@ void EventPoller::runLoop(bool blocked, bool ref_self) {
                 }
 
                 try {
+                    BusyScope scope(*this, "fd event", record->fd);
                     record->call_back(record->attach);
                 } catch (std::exception &ex) {
                     ErrorL << "Exception occurred when do event task: " << ex.what();
                 }
             });
             callback_list.clear();
+            onReadyList();
+            if (!task_drained_ && !list_pending_.empty()) {
+                // 本次循环没有管道事件，继续执行上次被推迟的任务
+                drainTask();
+            }
         }
 #endif // HAS_EPOLL
     } else {
@@ -271,11 +366,11 @@ Task::Ptr EventPoller::async_I(TaskIn task, bool may_sync, bool first) {
         task();
         return nullptr;
     }
-    auto task_ptr = std::make_shared<Task>(std::move(task));
+    auto task_ptr = std::make_shared<TracedTask>(std::move(task), isTraceEnabled());
     {
         std::lock_guard<std::mutex> lock(mtx_task_);
         if (first) {
-            list_task_.emplace_front(task_ptr);
+            list_task_first_.emplace_front(task_ptr);
         } else {
             list_task_.emplace_back(task_ptr);
         }
@@ -285,6 +380,22 @@ Task::Ptr EventPoller::async_I(TaskIn task, bool may_sync, bool first) {
     return task_ptr;
 }
 
+Task::Ptr EventPoller::async_deadline(TaskIn task, uint64_t deadline_ms, bool may_sync) {
+    TimeTicker();
+    if (may_sync && isCurrentThread()) {
+        // 任务抛异常时也需统计截止时间
+        OnceToken token(nullptr, [&]() { onDeadlineTaskDone(deadline_ms); });
+        task();
+        return nullptr;
+    }
+    auto task_ptr = std::make_shared<TracedTask>(std::move(task), isTraceEnabled());
+    {
+        std::lock_guard<std::mutex> lock(mtx_task_);
+        deadline_task_.emplace(deadline_ms, task_ptr);
+    }
+    pipe_.write("", 1);
+    return task_ptr;
+}
 
 int EventPoller::addEvent(int fd, int event, PollEventCB cb) {
     TimeTicker();
@@ -295,6 +406,7 @@ int EventPoller::addEvent(int fd, int event, PollEventCB cb) {
 
     if (isCurrentThread()) {
 #if defined(HAS_EPOLL)
+        mergeEventOp();
         struct epoll_event ev = {0};
         ev.events = toEpoll(event) ;
         ev.data.fd = fd;
@@ -322,13 +434,86 @@ int EventPoller::addEvent(int fd, int event, PollEventCB cb) {
 #endif // HAS_EPOLL
     } 
 
+#if defined(HAS_EPOLL)
+    // epoll_ctl是线程安全的，直接注册，回调由poller线程在下次循环时合并到event_map_
+    struct epoll_event ev = {0};
+    ev.events = toEpoll(event);
+    ev.data.fd = fd;
+    lock_guard<mutex> lck(mtx_event_);
+    // 先登记再注册，保证poller线程收到该fd的事件时一定能找到回调
+    event_ops_.emplace_back(EventOp { EventOp::Op_Add, fd, event, std::make_shared<PollEventCB>(std::move(cb)), nullptr, true });
+    has_event_op_.store(true, memory_order_release);
+    int ret = epoll_ctl(event_fd_, EPOLL_CTL_ADD, fd, &ev);
+    if (ret == -1) {
+        event_ops_.pop_back();
+    }
+    return ret;
+#else
     async([this, fd, event, cb]() mutable {
         addEvent(fd, event, std::move(cb));
     });
     return 0;
+#endif // HAS_EPOLL
 }
 
 
+int EventPoller::addBudgetEvent(int fd, int event, PollBudgetCB cb) {
+    if (!cb) {
+        WarnL << "PollBudgetCB is empty";
+        return -1;
+    }
+    class BudgetState {
+    public:
+        // 是否已在就绪列表中，避免重复加入
+        bool queued = false;
+        // 最近一次回调所在的循环次数，本次循环已经触发过事件时不再重复回调
+        uint64_t iteration = 0;
+    };
+    auto state = std::make_shared<BudgetState>();
+    return addEvent(fd, event, [this, fd, cb, state](int event) {
+        auto iteration = loop_iteration_.load(memory_order_relaxed);
+        if (in_ready_list_ && state->iteration == iteration) {
+            return;
+        }
+        state->iteration = iteration;
+        state->queued = false;
+        // 本监听记录，回调中可能删除并重新监听该fd，只有记录未变时才加入就绪列表
+        auto it = event_map_.find(fd);
+        auto record = it != event_map_.end() ? it->second.get() : nullptr;
+        if (cb(event) && !state->queued) {
+            it = event_map_.find(fd);
+            if (it != event_map_.end() && it->second.get() == record) {
+                state->queued = true;
+                ready_list_.emplace_back(ReadyEvent { fd, event, it->second });
+            }
+        }
+    });
+}
+
+void EventPoller::onReadyList() {
+    in_ready_list_ = true;
+    for (auto &ready : ready_swap_) {
+        auto fd = ready.fd;
+        auto it = event_map_.find(fd);
+        if (it == event_map_.end() || it->second != ready.record || event_cache_expired_.count(fd)) {
+            // 该fd已经被删除，或者删除后被复用并重新监听
+            continue;
+        }
+        try {
+            BusyScope scope(*this, "fd event", fd);
+#if defined(HAS_EPOLL)
+            (*ready.record)(ready.event);
+#else
+            ready.record->call_back(ready.event);
+#endif
+        } catch (std::exception &ex) {
+            ErrorL << "Exception occurred when do event task: " << ex.what();
+        }
+    }
+    ready_swap_.clear();
+    in_ready_list_ = false;
+}
+
 int EventPoller::delEvent(int fd, PollCompleteCB cb) {
     TimeTicker();
     if (!cb) {
@@ -337,6 +522,8 @@ int EventPoller::delEvent(int fd, PollCompleteCB cb) {
 
     if(isCurrentThread()) {
 #if defined(HAS_EPOLL)
+        mergeEventOp();
+        dropModifyEvent(fd);
         int ret = -1;
         if (event_map_.erase(fd)) {
             event_cache_expired_.emplace(fd);
@@ -346,8 +533,6 @@ int EventPoller::delEvent(int fd, PollCompleteCB cb) {
         fd_count_ = event_map_.size();
         return ret;
 
-#elif defined(HAS_KQUEUE)
-
 #else 
         int ret = -1;
         if (event_map_.erase(fd)) {
@@ -360,29 +545,75 @@ int EventPoller::delEvent(int fd, PollCompleteCB cb) {
 #endif // HAS_EPOLL
     }
 
+#if defined(HAS_EPOLL)
+    // 直接移除监听，回调记录的删除和完成回调由poller线程按顺序执行
+    {
+        lock_guard<mutex> lck(mtx_event_);
+        auto ret = epoll_ctl(event_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        event_ops_.emplace_back(EventOp { EventOp::Op_Del, fd, 0, nullptr, std::move(cb), ret != -1 });
+        has_event_op_.store(true, memory_order_release);
+    }
+    pipe_.write("", 1);
+#else
     //Cross-thread operation
     async([this, fd, cb]() mutable {
         delEvent(fd, std::move(cb));
     });
+#endif // HAS_EPOLL
     return 0;
 }
 
 int EventPoller::modifyEvent(int fd, int event, PollCompleteCB cb) {
     TimeTicker();
+#if defined(HAS_EPOLL)
+    if (!isCurrentThread()) {
+        modify_requested_.fetch_add(1, memory_order_relaxed);
+        if (batch_modify_.load(memory_order_relaxed)) {
+            // 与poller线程中的修改按顺序合并，否则会被其先前记录的修改覆盖
+            {
+                lock_guard<mutex> lck(mtx_event_);
+                event_ops_.emplace_back(EventOp { EventOp::Op_Modify, fd, event, nullptr, std::move(cb), false, true });
+                has_event_op_.store(true, memory_order_release);
+            }
+            pipe_.write("", 1);
+            return 0;
+        }
+        struct epoll_event ev = { 0 };
+        ev.events = toEpoll(event);
+        ev.data.fd = fd;
+        lock_guard<mutex> lck(mtx_event_);
+        auto ret = epoll_ctl(event_fd_, EPOLL_CTL_MOD, fd, &ev);
+        modify_applied_.fetch_add(1, memory_order_relaxed);
+        if (cb) {
+            // 完成回调仍然在poller线程执行
+            event_ops_.emplace_back(EventOp { EventOp::Op_Modify, fd, event, nullptr, std::move(cb), ret != -1 });
+            has_event_op_.store(true, memory_order_release);
+            pipe_.write("", 1);
+        }
+        return ret;
+    }
+#endif // HAS_EPOLL
+
     if (!cb) {
         cb = [](bool success) {};
     }
 
     if(isCurrentThread()) {
 #if defined(HAS_EPOLL)
+        modify_requested_.fetch_add(1, memory_order_relaxed);
+        if (batch_modify_.load(memory_order_relaxed)) {
+            // 只记录最终的监听事件，等待前统一修改
+            dirty_event_[fd] = dirty_modify_.size();
+            dirty_modify_.emplace_back(DirtyModify { fd, event, std::move(cb), false, false });
+            return 0;
+        }
         struct epoll_event ev = { 0 };
         ev.events = toEpoll(event);
         ev.data.fd = fd;
         auto ret = epoll_ctl(event_fd_, EPOLL_CTL_MOD, fd, &ev);
+        modify_applied_.fetch_add(1, memory_order_relaxed);
         cb(ret != -1);
         return ret;
-#elif defined(HAS_KQUEUE)
-
 #else 
         auto it = event_map_.find(fd);
         if (it != event_map_.end()) {
@@ -399,6 +630,122 @@ int EventPoller::modifyEvent(int fd, int event, PollCompleteCB cb) {
     return 0;
 }
 
+void EventPoller::enableBatchModify(bool enable) {
+#if defined(HAS_EPOLL)
+    batch_modify_.store(enable, memory_order_relaxed);
+#endif // HAS_EPOLL
+}
+
+void EventPoller::getModifyStatistic(uint64_t &requested, uint64_t &applied) const {
+    requested = modify_requested_.load(memory_order_relaxed);
+    applied = modify_applied_.load(memory_order_relaxed);
+}
+
+#if defined(HAS_EPOLL)
+void EventPoller::flushModifyEvent() {
+    if (dirty_modify_.empty() && !batch_modify_.load(memory_order_relaxed)) {
+        return;
+    }
+    // 其他线程刚注册的fd也可能已被批量修改，其他线程的批量修改也在其中，先合并
+    mergeEventOp();
+    if (dirty_modify_.empty()) {
+        return;
+    }
+    size_t applied = 0;
+    for (auto &pr : dirty_event_) {
+        auto &modify = dirty_modify_[pr.second];
+        if (!event_map_.count(modify.fd)) {
+            continue;
+        }
+        // 即使与当前监听事件相同也要修改，EPOLLET下MOD会重新检查就绪状态，与非批量模式一致
+        struct epoll_event ev = { 0 };
+        ev.events = toEpoll(modify.event);
+        ev.data.fd = modify.fd;
+        ++applied;
+        modify.success = epoll_ctl(event_fd_, EPOLL_CTL_MOD, modify.fd, &ev) != -1;
+    }
+    modify_applied_.fetch_add(applied, memory_order_relaxed);
+
+    // 先取出再回调，回调中可能再次修改
+    decltype(dirty_modify_) modifies;
+    decltype(dirty_event_) latest;
+    modifies.swap(dirty_modify_);
+    latest.swap(dirty_event_);
+    for (auto &modify : modifies) {
+        if (!modify.cb) {
+            continue;
+        }
+        // 同一fd的多次修改以最后一次的结果为准，fd被删除后的修改均失败
+        bool success = false;
+        if (!modify.dropped) {
+            auto it = latest.find(modify.fd);
+            success = it != latest.end() && modifies[it->second].success;
+        }
+        try {
+            modify.cb(success);
+        } catch (std::exception &ex) {
+            ErrorL << "Exception occurred when do modify event callback: " << ex.what();
+        }
+    }
+}
+
+void EventPoller::dropModifyEvent(int fd) {
+    if (!dirty_event_.erase(fd)) {
+        return;
+    }
+    for (auto &modify : dirty_modify_) {
+        if (modify.fd == fd) {
+            modify.dropped = true;
+        }
+    }
+}
+
+void EventPoller::mergeEventOp(bool force) {
+    if (!force && !has_event_op_.load(memory_order_acquire)) {
+        return;
+    }
+    decltype(event_ops_) ops;
+    {
+        lock_guard<mutex> lck(mtx_event_);
+        ops.swap(event_ops_);
+        has_event_op_.store(false, memory_order_relaxed);
+    }
+    for (auto &op : ops) {
+        switch (op.type) {
+            case EventOp::Op_Add: {
+                event_map_[op.fd] = std::move(op.cb);
+                break;
+            }
+            case EventOp::Op_Del: {
+                if (event_map_.erase(op.fd)) {
+                    event_cache_expired_.emplace(op.fd);
+                }
+                dropModifyEvent(op.fd);
+                break;
+            }
+            case EventOp::Op_Modify: {
+                if (op.deferred) {
+                    // 其他线程在批量模式下的修改，在下次等待前与本线程的修改一起生效并回调
+                    dirty_event_[op.fd] = dirty_modify_.size();
+                    dirty_modify_.emplace_back(DirtyModify { op.fd, op.event, std::move(op.complete), false, false });
+                    continue;
+                }
+                break;
+            }
+            default: break;
+        }
+        if (op.complete) {
+            try {
+                op.complete(op.success);
+            } catch (std::exception &ex) {
+                ErrorL << "Exception occurred when do event complete callback: " << ex.what();
+            }
+        }
+    }
+    fd_count_ = event_map_.size();
+}
+#endif // HAS_EPOLL
+
 EventPoller::DelayTask::Ptr EventPoller::doDelayTask(uint64_t delay_ms, function<uint64_t()> task) {
     auto delay_task = std::make_shared<DelayTask>(std::move(task));
     auto time_line = getCurrentMillisecond() + delay_ms;
@@ -416,6 +763,7 @@ int64_t EventPoller::flushDelayTask(uint64_t now_time) {
     for(auto it = task_copy.begin(); it != task_copy.end() && it->first <= now_time; it = task_copy.erase(it)) {
         //Expired tasks
         try {
+            BusyScope scope(*this, "delay task");
             auto next_delay = (*(it->second))();
             if (next_delay) { 
                 delay_task_map_.emplace(next_delay + now_time, std::move(it->second));
@@ -436,6 +784,83 @@ int64_t EventPoller::flushDelayTask(uint64_t now_time) {
     return it->first - now_time; 
 }
 
+EventPoller::IdleTask::Ptr EventPoller::onIdle(function<bool()> task) {
+    auto idle_task = std::make_shared<IdleTask>(std::move(task));
+    async_first([this, idle_task]() {
+        idle_task_.emplace_back(idle_task);
+    });
+    return idle_task;
+}
+
+void EventPoller::setIdleParam(uint64_t interval_ms, uint64_t max_delay_ms, uint64_t max_usec) {
+    idle_interval_ms_.store(interval_ms, memory_order_relaxed);
+    idle_max_delay_ms_.store(max_delay_ms, memory_order_relaxed);
+    idle_max_usec_.store(max_usec, memory_order_relaxed);
+}
+
+SocketRecvBuffer::Ptr EventPoller::getSharedBuffer(bool is_udp, bool gro) {
+    gro = is_udp && gro;
+    auto &buffer = shared_buffer_[gro ? 2 : is_udp];
+    if (!buffer) {
+        buffer = SocketRecvBuffer::create(is_udp, gro);
+    }
+    return buffer;
+}
+
+int64_t EventPoller::checkIdleTask(int64_t min_delay) {
+    if (idle_task_.empty()) {
+        return min_delay;
+    }
+    auto interval = (int64_t)idle_interval_ms_.load(memory_order_relaxed);
+    auto elapsed = (int64_t)(getCurrentMillisecond() - idle_last_);
+    if (elapsed >= (int64_t)idle_max_delay_ms_.load(memory_order_relaxed)) {
+        // 持续繁忙太久，在预算内强制执行
+        runIdleTask();
+        elapsed = 0;
+    } else if (min_delay != 0 && elapsed >= interval) {
+        // 先不休眠地检查一次，没有任何事件才说明确实空闲
+        idle_probe_ = true;
+        return 0;
+    }
+    if (min_delay != 0) {
+        // 空闲时按间隔醒来执行空闲回调
+        auto left = interval > elapsed ? interval - elapsed : 0;
+        if (min_delay < 0 || min_delay > left) {
+            min_delay = left;
+        }
+    }
+    return min_delay;
+}
+
+void EventPoller::runIdleTask() {
+    idle_last_ = getCurrentMillisecond();
+    auto max_usec = idle_max_usec_.load(memory_order_relaxed);
+    auto start = TaskTracer::now();
+    auto count = idle_task_.size();
+    for (size_t i = 0; i < count && !idle_task_.empty(); ++i) {
+        if (i && max_usec && TaskTracer::now() - start >= max_usec * 1000) {
+            // 超出预算，剩余回调下次执行
+            break;
+        }
+        if (idle_pos_ >= idle_task_.size()) {
+            idle_pos_ = 0;
+        }
+        bool keep = false;
+        try {
+            BusyScope scope(*this, "idle task");
+            keep = (*idle_task_[idle_pos_])();
+        } catch (std::exception &ex) {
+            ErrorL << "Exception occurred when do idle task: " << ex.what();
+        }
+        if (keep) {
+            ++idle_pos_;
+        } else {
+            // 返回false或者已被取消
+            idle_task_.erase(idle_task_.begin() + idle_pos_);
+        }
+    }
+}
+
 int64_t EventPoller::getMinDelay() {
     if (delay_task_map_.empty()) {
         //No remaining timers
@@ -452,6 +877,11 @@ int64_t EventPoller::getMinDelay() {
 }
 
 
+static inline const char *taskLabel(const TracedTask &task) {
+    auto label = task.label();
+    return label ? label : "async task";
+}
+
 inline void EventPoller::onPipeEvent(bool flush) {
     char buf[1024];
     int err = 0;
@@ -473,21 +903,64 @@ inline void EventPoller::onPipeEvent(bool flush) {
         }
     }
 
-    decltype(list_task_) list_swap_;
+    decltype(deadline_task_) deadline_swap_;
     {
         lock_guard<mutex> lck(mtx_task_);
-        list_swap_.swap(list_task_);
+        // async_first的任务排在上次被推迟的任务之前，普通任务排在其后
+        list_pending_.splice(list_pending_.begin(), list_task_first_);
+        list_pending_.append(list_task_);
+        deadline_swap_.swap(deadline_task_);
     }
-    
-    list_swap_.for_each([&](const Task::Ptr &task) {
+
+    // 带截止时间的任务按截止时间先后执行(EDF)，优先于普通任务
+    for (auto &pr : deadline_swap_) {
         try {
-            (*task)();
+            BusyScope scope(*this, taskLabel(*pr.second));
+            runTracedTask(*pr.second);
         } catch (ExitException &) {
             exit_flag_ = true;
         } catch (std::exception &ex) {
             ErrorL << "Exception occurred when do async task: " << ex.what();
         }
-    });
+        onDeadlineTaskDone(pr.first);
+    }
+
+    drainTask(flush);
+}
+
+void EventPoller::drainTask(bool unlimited) {
+    task_drained_ = true;
+    auto max_tasks = unlimited ? 0 : budget_tasks_.load(memory_order_relaxed);
+    auto max_usec = unlimited ? 0 : budget_usec_.load(memory_order_relaxed);
+    auto start = max_usec ? TaskTracer::now() : 0;
+    size_t count = 0;
+    while (!list_pending_.empty()) {
+        if ((max_tasks && count >= max_tasks) || (max_usec && count && TaskTracer::now() - start >= max_usec * 1000)) {
+            // 预算耗尽，剩余任务推迟到下次循环
+            budget_hit_.fetch_add(1, memory_order_relaxed);
+            break;
+        }
+        auto task = std::move(list_pending_.front());
+        list_pending_.pop_front();
+        ++count;
+        try {
+            BusyScope scope(*this, taskLabel(*task));
+            runTracedTask(*task);
+        } catch (ExitException &) {
+            exit_flag_ = true;
+        } catch (std::exception &ex) {
+            ErrorL << "Exception occurred when do async task: " << ex.what();
+        }
+    }
+}
+
+void EventPoller::setTaskBudget(size_t max_tasks, uint64_t max_usec) {
+    budget_tasks_.store(max_tasks, memory_order_relaxed);
+    budget_usec_.store(max_usec, memory_order_relaxed);
+}
+
+uint64_t EventPoller::getTaskBudgetHit() const {
+    return budget_hit_.load(memory_order_relaxed);
 }
 
 
@@ -527,4 +1000,58 @@ void EventPollerPool::preferCurrentThread(bool flag) {
     prefer_current_thread_ = flag;
 }
 
+void EventPollerPool::enableRendezvousHash(bool enable) {
+    rendezvous_hash_.store(enable, memory_order_relaxed);
+}
+
+// splitmix64，打散key的分布
+static inline uint64_t mixHash(uint64_t key) {
+    key += 0x9E3779B97F4A7C15ULL;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+    return key ^ (key >> 31);
+}
+
+size_t EventPollerPool::getIndexForKey(uint64_t key, size_t count, bool rendezvous) {
+    auto hash = mixHash(key);
+    if (!rendezvous) {
+        return hash % count;
+    }
+    // 选取(key, poller序号)权重最大的poller，poller个数变化时仅影响少量key
+    size_t index = 0;
+    uint64_t max_weight = 0;
+    for (size_t i = 0; i < count; ++i) {
+        auto weight = mixHash(hash ^ mixHash(i + 1));
+        if (i == 0 || weight > max_weight) {
+            max_weight = weight;
+            index = i;
+        }
+    }
+    return index;
+}
+
+EventPoller::Ptr EventPollerPool::getPollerForKey(uint64_t key) {
+    if (threads_.empty()) {
+        return nullptr;
+    }
+    auto index = getIndexForKey(key, threads_.size(), rendezvous_hash_.load(memory_order_relaxed));
+    return static_pointer_cast<EventPoller>(threads_[index]);
+}
+
+EventPoller::Ptr EventPollerPool::getPollerForKey(const string &key) {
+    return getPollerForKey((uint64_t)std::hash<string>()(key));
+}
+
+Task::Ptr EventPollerPool::asyncKeyed(uint64_t key, TaskIn task, bool may_sync) {
+    auto poller = getPollerForKey(key);
+    if (!poller) {
+        throw std::runtime_error("No EventPoller in pool for keyed task");
+    }
+    return poller->async(std::move(task), may_sync);
+}
+
+Task::Ptr EventPollerPool::asyncKeyed(const string &key, TaskIn task, bool may_sync) {
+    return asyncKeyed((uint64_t)std::hash<string>()(key), std::move(task), may_sync);
+}
+
 } // FFZKit
\ No newline at end of file
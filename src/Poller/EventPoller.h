@@ -5,6 +5,7 @@
 #ifndef FFZKIT_EVENTPOLLER_H
 #define FFZKIT_EVENTPOLLER_H
 
+#include <map>
 #include <memory>
 #include <unordered_set>
 #include <unordered_map>
@@ -15,11 +16,7 @@
 #include "Thread/TaskExecutor.h"
 #include "Thread/ThreadPool.h"
 
-#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
-#define HAS_KQUEUE
-#endif // __APPLE__
-
-#if defined(HAS_EPOLL) || defined(HAS_KQUEUE)
+#if defined(HAS_EPOLL)
 #if defined(_WIN32)
 using epoll_fd = void *;
 constexpr epoll_fd INVALID_EVENT_FD = nullptr;
@@ -32,14 +29,19 @@ constexpr epoll_fd INVALID_EVENT_FD = -1;
 
 namespace FFZKit {
 
+class SocketRecvBuffer;
+
 class EventPoller : public TaskExecutor, public std::enable_shared_from_this<EventPoller>  {
 public:
     friend class TaskExecutorGetterImp;
+    friend class PollerWatchdog;
 
     using Ptr = std::shared_ptr<EventPoller>;
     using PollEventCB = std::function<void(int event)>;
     using DelayTask = TaskCancelableImp<uint64_t(void)>;
+    using IdleTask = TaskCancelableImp<bool(void)>;
     using PollCompleteCB = std::function<void(bool success)>;
+    using PollBudgetCB = std::function<bool(int event)>;
 
     typedef enum {
         Event_Read = 1 << 0, //读事件
@@ -56,9 +58,21 @@ public:
      * @param event 事件类型，例如 Event_Read | Event_Write
      * @param cb 事件回调functional
      * @return -1:失败，0:成功
+     * epoll模式下可在任意线程调用，直接注册到epoll而无需切换到poller线程，回调始终在poller线程执行
      */
     int addEvent(int fd, int event, PollEventCB cb);
 
+    /**
+     * 添加带读预算的事件监听，用于边沿触发模式下多个高负载fd之间的公平调度
+     * 回调每次只处理有限的数据量，若返回true(表示还有数据未处理)，poller会把该fd放入自身的就绪列表，
+     * 在下次循环中用相同的事件再次回调，期间不阻塞等待，也不需要再经过epoll_wait重新触发
+     * @param fd 监听的文件描述符
+     * @param event 事件类型，例如 Event_Read | Event_Write
+     * @param cb 事件回调，返回值代表是否还有待处理的数据
+     * @return -1:失败，0:成功
+     */
+    int addBudgetEvent(int fd, int event, PollBudgetCB cb);
+
     /**
      * 删除事件监听
      * @param fd 监听的文件描述符
@@ -72,8 +86,28 @@ public:
      */
     int delEvent(int fd, PollCompleteCB cb = nullptr);
 
+    /**
+     * 修改事件监听
+     * epoll模式下在其他线程调用时直接修改，返回值即为修改结果；cb仍然在poller线程执行
+     * 批量修改模式下其他线程的修改同样交由poller线程按顺序合并生效，返回值固定为0
+     */
     int modifyEvent(int fd, int event, PollCompleteCB cb = nullptr);
 
+    /**
+     * 开启批量修改事件监听模式(仅epoll有效)
+     * 开启后在poller线程中调用modifyEvent只记录最终的监听事件，在下次等待前统一调用epoll_ctl，
+     * 同一次循环内对同一fd的多次修改合并为一次；
+     * 此时modifyEvent返回值固定为0，修改结果通过cb通知；其他线程的修改也排入同一列表，避免被较早的修改覆盖
+     */
+    void enableBatchModify(bool enable = true);
+
+    /**
+     * 获取modifyEvent的统计
+     * @param requested modifyEvent调用次数
+     * @param applied 实际调用epoll_ctl的次数
+     */
+    void getModifyStatistic(uint64_t &requested, uint64_t &applied) const;
+
     size_t fdCount() const;
 
      /**
@@ -86,8 +120,29 @@ public:
 
     Task::Ptr async_first(TaskIn task, bool may_sync = true) override;
 
+    /**
+     * 带截止时间异步执行任务，每次唤醒时先按截止时间先后执行这类任务，再执行普通任务
+     * @param task 任务
+     * @param deadline_ms 截止时间点，与getCurrentMillisecond()同一时间基准
+     * @param may_sync 如果调用该函数的线程就是本对象的轮询线程，那么may_sync为true时就是同步执行任务
+     */
+    Task::Ptr async_deadline(TaskIn task, uint64_t deadline_ms, bool may_sync = true) override;
+
     bool isCurrentThread();
 
+    /**
+     * 设置每次事件循环执行异步任务的预算，超出后剩余任务推迟到下次循环执行，且下次循环不再阻塞等待
+     * 避免大量跨线程任务饿死socket事件和定时器；带截止时间的任务不受预算限制
+     * @param max_tasks 每次循环最多执行的任务个数，0为不限制
+     * @param max_usec 每次循环执行任务的最长耗时，单位微秒，0为不限制
+     */
+    void setTaskBudget(size_t max_tasks, uint64_t max_usec = 0);
+
+    /**
+     * 任务预算耗尽(有任务被推迟到下次循环)的次数
+     */
+    uint64_t getTaskBudgetHit() const;
+
      /**
      * 延时执行某个任务
      * @param delay_ms 延时毫秒数
@@ -96,6 +151,32 @@ public:
      */
     DelayTask::Ptr doDelayTask(uint64_t delay_ms, std::function<uint64_t()> task);
 
+    /**
+     * 注册空闲回调，用于内存池收缩、日志刷新等低优先级的维护工作
+     * 空闲回调只在事件循环即将休眠时执行，且两次执行至少间隔interval_ms(见setIdleParam)；
+     * 若事件循环持续繁忙超过max_delay_ms，则在预算内强制执行一次，避免维护工作被无限推迟
+     * @param task 空闲回调，返回false时不再执行
+     * @return 可取消的任务标签
+     */
+    IdleTask::Ptr onIdle(std::function<bool()> task);
+
+    /**
+     * 获取本poller线程下所有socket共享的读缓存，只能在poller线程调用
+     * 读取到的数据直接以该缓存中的Buffer交给使用者，大量空闲连接无需各自持有读缓存；
+     * 若使用者在回调之后仍持有该Buffer，下次读取时会重新分配，已交出的数据不会被覆盖
+     * @param is_udp 是否为udp，udp的读缓存可一次读取多个数据报
+     * @param gro 是否为开启了GRO的udp，见Socket::enableUdpGro
+     */
+    std::shared_ptr<SocketRecvBuffer> getSharedBuffer(bool is_udp, bool gro = false);
+
+    /**
+     * 设置空闲回调的执行参数
+     * @param interval_ms 两次执行空闲回调的最小间隔，默认100ms
+     * @param max_delay_ms 持续繁忙时最长推迟时间，默认1000ms
+     * @param max_usec 每次执行空闲回调的耗时预算，超出后剩余回调下次执行，默认1000us
+     */
+    void setIdleParam(uint64_t interval_ms, uint64_t max_delay_ms, uint64_t max_usec);
+
 
      /**
      * 获取当前线程关联的Poller实例
@@ -113,7 +194,27 @@ public:
      */
     const std::string &getThreadName() const;
 
+    /**
+     * 事件循环运行状态，由poller线程发布，供看门狗等其他线程读取
+     * 各字段分别读取，不保证是同一时刻的快照
+     */
+    class LoopState {
+    public:
+        // 事件循环迭代次数(心跳)
+        uint64_t iteration;
+        // 当前回调或任务的开始时间点(getCurrentMillisecond())，0表示空闲
+        uint64_t busy_since;
+        // 当前回调或任务的标签，异步任务为投递时的TaskLabel
+        const char *label;
+        // 当前事件回调对应的fd，非fd事件时为-1
+        int fd;
+    };
+
+    LoopState getLoopState() const;
+
 private:
+    class BusyScope;
+
     /**
      * 本对象只允许在EventPollerPool中构造
      */
@@ -139,6 +240,19 @@ private:
      */
     int64_t getMinDelay();
 
+    /**
+     * 检查空闲回调是否需要执行
+     * 到期时本次循环不休眠，若没有任何事件则说明确实空闲，随后执行空闲回调；持续繁忙过久时直接执行
+     * @param min_delay 本次循环的休眠时长，-1为无限
+     * @return 调整后的休眠时长，保证空闲时能按间隔执行空闲回调
+     */
+    int64_t checkIdleTask(int64_t min_delay);
+
+    /**
+     * 在预算内执行空闲回调
+     */
+    void runIdleTask();
+
     /**
      * 添加管道监听事件
      */
@@ -151,6 +265,35 @@ private:
      */
     void onPipeEvent(bool flush = false);
 
+    /**
+     * 按预算执行被推迟的任务
+     * @param unlimited 是否忽略预算执行全部任务
+     */
+    void drainTask(bool unlimited = false);
+
+    /**
+     * 回调上次循环中还有待处理数据的fd
+     */
+    void onReadyList();
+
+#if defined(HAS_EPOLL)
+    /**
+     * 合并其他线程登记的事件监听操作，仅在poller线程调用
+     * @param force 是否忽略登记标记，强制加锁检查
+     */
+    void mergeEventOp(bool force = false);
+
+    /**
+     * 批量修改模式下，使记录的监听事件修改生效
+     */
+    void flushModifyEvent();
+
+    /**
+     * fd被删除时，其未生效的修改作废并在flushModifyEvent中回调失败
+     */
+    void dropModifyEvent(int fd);
+#endif
+
     /**
      * 切换线程并执行任务
      * @param task
@@ -182,15 +325,61 @@ private:
 
     // 从其他线程切换过来的任务 
     std::mutex mtx_task_;
-    List<Task::Ptr> list_task_;
+    List<TracedTask::Ptr> list_task_;
+    // async_first切换过来的任务，后加入的在前
+    List<TracedTask::Ptr> list_task_first_;
+    // 带截止时间的任务，按截止时间排序
+    std::multimap<uint64_t, TracedTask::Ptr> deadline_task_;
+
+    // 已从list_task_取出但因预算耗尽而推迟执行的任务，仅poller线程访问
+    List<TracedTask::Ptr> list_pending_;
+    // 本次循环是否已经执行过任务
+    bool task_drained_ = false;
+    // 任务执行预算，见setTaskBudget
+    std::atomic<size_t> budget_tasks_ { 0 };
+    std::atomic<uint64_t> budget_usec_ { 0 };
+    std::atomic<uint64_t> budget_hit_ { 0 };
 
     // 保持日志可用
     Logger::Ptr logger_;
 
-#if defined(HAS_EPOLL) || defined(HAS_KQUEUE)
-    // epoll和kqueue相关
+#if defined(HAS_EPOLL)
+    // epoll相关
     epoll_fd event_fd_ = INVALID_EVENT_FD;
     std::unordered_map<int, std::shared_ptr<PollEventCB>> event_map_;
+
+    // 其他线程直接调用epoll_ctl后登记的操作，由poller线程按顺序合并到event_map_
+    class EventOp {
+    public:
+        enum Type { Op_Add, Op_Modify, Op_Del };
+        Type type;
+        int fd;
+        int event;
+        std::shared_ptr<PollEventCB> cb;
+        PollCompleteCB complete;
+        bool success;
+        // Op_Modify尚未生效，合并时加入批量修改列表
+        bool deferred;
+    };
+    std::mutex mtx_event_;
+    std::vector<EventOp> event_ops_;
+    std::atomic<bool> has_event_op_ { false };
+
+    // 批量修改模式，见enableBatchModify
+    std::atomic<bool> batch_modify_ { false };
+    // 待生效的监听事件修改，按调用顺序记录，每条修改单独回调结果
+    struct DirtyModify {
+        int fd;
+        int event;
+        PollCompleteCB cb;
+        // 该fd在生效前被删除
+        bool dropped;
+        // 最后一次修改的epoll_ctl结果
+        bool success;
+    };
+    std::vector<DirtyModify> dirty_modify_;
+    // fd最后一次修改在dirty_modify_中的下标
+    std::unordered_map<int, size_t> dirty_event_;
 #else
     // select相关 
     struct Poll_Record {
@@ -205,11 +394,45 @@ private:
 
     std::unordered_set<int> event_cache_expired_; // 缓存已经删除的fd，防止重复删除
 
-    //当前线程下，所有socket共享的读缓存
-    //std::weak_ptr<SocketRecvBuffer> shared_buffer_[2];
+    // 还有待处理数据的fd及其事件，见addBudgetEvent，仅poller线程访问
+    // 同时持有加入时的监听记录，fd被删除后复用时不会把旧事件回调给新的监听
+    class ReadyEvent {
+    public:
+        int fd;
+        int event;
+        decltype(event_map_)::mapped_type record;
+    };
+    std::vector<ReadyEvent> ready_list_;
+    std::vector<ReadyEvent> ready_swap_;
+    // 是否正在回调就绪列表中的fd
+    bool in_ready_list_ = false;
+
+    // 事件循环运行状态，见LoopState
+    std::atomic<uint64_t> loop_iteration_ { 0 };
+    std::atomic<uint64_t> busy_since_ { 0 };
+    std::atomic<const char *> busy_label_ { nullptr };
+    std::atomic<int> busy_fd_ { -1 };
+
+    // modifyEvent统计，见getModifyStatistic
+    std::atomic<uint64_t> modify_requested_ { 0 };
+    std::atomic<uint64_t> modify_applied_ { 0 };
+
+    //当前线程下，所有socket共享的读缓存，分别用于tcp、udp与开启GRO的udp
+    std::shared_ptr<SocketRecvBuffer> shared_buffer_[3];
 
      // 定时器相关 
     std::multimap<uint64_t, DelayTask::Ptr> delay_task_map_;
+
+    // 空闲回调相关，见onIdle
+    std::vector<IdleTask::Ptr> idle_task_;
+    // 下次从该位置开始执行，保证每个回调都有机会执行
+    size_t idle_pos_ = 0;
+    uint64_t idle_last_ = 0;
+    // 本次循环是否在检查空闲
+    bool idle_probe_ = false;
+    std::atomic<uint64_t> idle_interval_ms_ { 100 };
+    std::atomic<uint64_t> idle_max_delay_ms_ { 1000 };
+    std::atomic<uint64_t> idle_max_usec_ { 1000 };
 };
 
 class EventPollerPool : public TaskExecutorGetterImp, public std::enable_shared_from_this<EventPollerPool> {
@@ -249,11 +472,46 @@ public:
      */
     void preferCurrentThread(bool flag = true);
 
+    /**
+     * 根据key获取固定的EventPoller实例，相同的key总是返回同一个实例
+     * 同一会话/流的所有操作都在同一线程执行，访问其状态无需加锁
+     * @param key 会话或流的标识
+     * @return 池中没有poller时返回nullptr
+     */
+    EventPoller::Ptr getPollerForKey(uint64_t key);
+    EventPoller::Ptr getPollerForKey(const std::string &key);
+
+    /**
+     * 在key对应的EventPoller上异步执行任务
+     * @param key 会话或流的标识
+     * @param task 任务
+     * @param may_sync 如果当前线程就是该poller线程，那么may_sync为true时就是同步执行任务
+     * @throw std::runtime_error 池中没有poller
+     */
+    Task::Ptr asyncKeyed(uint64_t key, TaskIn task, bool may_sync = true);
+    Task::Ptr asyncKeyed(const std::string &key, TaskIn task, bool may_sync = true);
+
+    /**
+     * 设置key映射方式，默认取模
+     * 开启rendezvous hash后，poller个数变化时只有少量key会迁移，但每次映射的开销为O(poller个数)
+     * @param enable 是否开启rendezvous hash
+     */
+    void enableRendezvousHash(bool enable = true);
+
+    /**
+     * 计算key映射到的poller序号，可用于评估poller个数变化时key的迁移情况
+     * @param key 会话或流的标识
+     * @param count poller个数，不能为0
+     * @param rendezvous 是否使用rendezvous hash
+     */
+    static size_t getIndexForKey(uint64_t key, size_t count, bool rendezvous);
+
 private:
     EventPollerPool();
 
 private:
     bool prefer_current_thread_ = true;
+    std::atomic<bool> rendezvous_hash_ { false };
 };
 
 
@@ -0,0 +1,163 @@
+//
+// Created by FFZero on 2025-04-19.
+//
+
+#include "PollerWatchdog.h"
+#include "Util/util.h"
+#include "Util/onceToken.h"
+
+#if defined(__linux__) && defined(__GLIBC__)
+#include <csignal>
+#include <cstring>
+#include <unistd.h>
+#include <pthread.h>
+#include <execinfo.h>
+#define HAS_STACK_DUMP
+#endif
+
+using namespace std;
+
+namespace FFZKit {
+
+#if defined(HAS_STACK_DUMP)
+// 在被卡住的poller线程上执行，只使用异步信号安全的接口
+static void onStackSignal(int) {
+    void *frames[64];
+    auto size = backtrace(frames, 64);
+    static const char kHeader[] = "---- stalled poller stack ----\n";
+    auto ret = write(STDERR_FILENO, kHeader, sizeof(kHeader) - 1);
+    (void)ret;
+    backtrace_symbols_fd(frames, size, STDERR_FILENO);
+}
+
+static void installStackSignal() {
+    static OnceToken s_token([]() {
+        // 预先调用一次backtrace，避免在信号处理函数中首次加载libgcc
+        void *frames[1];
+        backtrace(frames, 1);
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = onStackSignal;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGUSR2, &sa, nullptr);
+    });
+}
+#endif
+
+PollerWatchdog::PollerWatchdog(uint64_t threshold_ms, bool dump_stack) {
+    _threshold_ms = threshold_ms ? threshold_ms : 1;
+    _dump_stack = dump_stack;
+#if defined(HAS_STACK_DUMP)
+    if (_dump_stack) {
+        installStackSignal();
+    }
+#else
+    if (_dump_stack) {
+        WarnL << "Stack dump of stalled poller is not supported on this platform";
+        _dump_stack = false;
+    }
+#endif
+    _thread = thread([this]() { run(); });
+}
+
+PollerWatchdog::~PollerWatchdog() {
+    _exit = true;
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+void PollerWatchdog::watch(const EventPoller::Ptr &poller) {
+    lock_guard<mutex> lck(_mtx);
+    _pollers.emplace_back(poller, 0);
+}
+
+void PollerWatchdog::watchPool() {
+    EventPollerPool::Instance().for_each([this](const TaskExecutor::Ptr &executor) {
+        watch(static_pointer_cast<EventPoller>(executor));
+    });
+}
+
+void PollerWatchdog::setOnStall(onStallCB cb) {
+    lock_guard<mutex> lck(_mtx);
+    _on_stall = std::move(cb);
+}
+
+size_t PollerWatchdog::stallCount() const {
+    return _stall_count;
+}
+
+void PollerWatchdog::run() {
+    setThreadName("poller watchdog");
+    // 检查周期为阈值的1/4，上报时长误差不超过该周期
+    auto interval = chrono::milliseconds((std::max)(_threshold_ms / 4, (uint64_t)1));
+    vector<pair<EventPoller::Ptr, Stall> > stalls;
+    onStallCB cb;
+    while (!_exit) {
+        this_thread::sleep_for(interval);
+        {
+            lock_guard<mutex> lck(_mtx);
+            for (auto &pr : _pollers) {
+                auto poller = pr.first.lock();
+                Stall stall;
+                if (poller && check(poller, pr.second, stall)) {
+                    stalls.emplace_back(std::move(poller), std::move(stall));
+                }
+            }
+            if (!stalls.empty()) {
+                cb = _on_stall;
+            }
+        }
+        // 在锁外回调和打印堆栈
+        for (auto &pr : stalls) {
+            report(pr.first, pr.second, cb);
+        }
+        stalls.clear();
+        cb = nullptr;
+    }
+}
+
+bool PollerWatchdog::check(const EventPoller::Ptr &poller, uint64_t &last_reported, Stall &stall) {
+    auto state = poller->getLoopState();
+    if (!state.busy_since || state.busy_since == last_reported) {
+        // 空闲，或者本次卡顿已经上报过
+        return false;
+    }
+    auto now = getCurrentMillisecond();
+    if (now < state.busy_since || now - state.busy_since < _threshold_ms) {
+        return false;
+    }
+    last_reported = state.busy_since;
+    ++_stall_count;
+
+    stall.poller = poller->getThreadName();
+    stall.label = state.label ? state.label : "unknown";
+    stall.fd = state.fd;
+    stall.elapsed_ms = now - state.busy_since;
+    stall.iteration = state.iteration;
+    return true;
+}
+
+void PollerWatchdog::report(const EventPoller::Ptr &poller, const Stall &stall, const onStallCB &cb) {
+    if (cb) {
+        cb(stall);
+    } else {
+        WarnL << "Poller stalled: " << stall.poller << ", running: " << stall.label
+              << (stall.fd != -1 ? StrPrinter << "(fd " << stall.fd << ")" : string())
+              << ", elapsed: " << stall.elapsed_ms << "ms, iteration: " << stall.iteration;
+    }
+    if (_dump_stack) {
+        dumpStack(poller);
+    }
+}
+
+void PollerWatchdog::dumpStack(const EventPoller::Ptr &poller) {
+#if defined(HAS_STACK_DUMP)
+    if (poller->loop_thread_) {
+        pthread_kill(poller->loop_thread_->native_handle(), SIGUSR2);
+    }
+#endif
+}
+
+} // namespace FFZKit
@@ -0,0 +1,93 @@
+//
+// Created by FFZero on 2025-04-19.
+//
+
+#ifndef FFZKIT_POLLERWATCHDOG_H
+#define FFZKIT_POLLERWATCHDOG_H
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <functional>
+#include "EventPoller.h"
+
+namespace FFZKit {
+
+/**
+ * EventPoller卡顿看门狗
+ * 后台线程定期读取各poller发布的LoopState，当某个回调或任务执行时间超过阈值时上报：
+ * poller名、当前回调/任务的标签(及fd)、已执行时长
+ * 可选通过信号让卡住的poller线程把自身调用栈打印到stderr(仅linux glibc)
+ */
+class PollerWatchdog : public noncopyable {
+public:
+    using Ptr = std::shared_ptr<PollerWatchdog>;
+
+    class Stall {
+    public:
+        // 卡住的poller线程名
+        std::string poller;
+        // 当前回调或任务的标签
+        const char *label;
+        // 当前事件回调对应的fd，非fd事件时为-1
+        int fd;
+        // 已执行时长，单位毫秒
+        uint64_t elapsed_ms;
+        // 卡顿期间事件循环的迭代次数，用于区分不同次卡顿
+        uint64_t iteration;
+    };
+
+    /**
+     * 卡顿回调，在看门狗线程触发；同一次卡顿只上报一次
+     */
+    using onStallCB = std::function<void(const Stall &stall)>;
+
+    /**
+     * @param threshold_ms 回调或任务执行超过该时长视为卡顿
+     * @param dump_stack 卡顿时是否通过SIGUSR2信号打印poller线程调用栈
+     */
+    PollerWatchdog(uint64_t threshold_ms = 1000, bool dump_stack = false);
+    ~PollerWatchdog();
+
+    /**
+     * 添加需要监视的poller，可在运行中添加
+     */
+    void watch(const EventPoller::Ptr &poller);
+
+    /**
+     * 监视EventPollerPool中的所有poller
+     */
+    void watchPool();
+
+    /**
+     * 设置卡顿回调，默认打印警告日志
+     */
+    void setOnStall(onStallCB cb);
+
+    /**
+     * 累计上报的卡顿次数
+     */
+    size_t stallCount() const;
+
+private:
+    void run();
+    bool check(const EventPoller::Ptr &poller, uint64_t &last_reported, Stall &stall);
+    void report(const EventPoller::Ptr &poller, const Stall &stall, const onStallCB &cb);
+    static void dumpStack(const EventPoller::Ptr &poller);
+
+private:
+    uint64_t _threshold_ms;
+    bool _dump_stack;
+    std::atomic<bool> _exit { false };
+    std::atomic<size_t> _stall_count { 0 };
+    // 保护_on_stall与_pollers，上报时不持有，回调中可以调用watch/setOnStall
+    std::mutex _mtx;
+    onStallCB _on_stall;
+    // poller及其最近一次已上报卡顿的开始时间
+    std::vector<std::pair<std::weak_ptr<EventPoller>, uint64_t> > _pollers;
+    std::thread _thread;
+};
+
+} // namespace FFZKit
+
+#endif //FFZKIT_POLLERWATCHDOG_H
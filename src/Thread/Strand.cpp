@@ -0,0 +1,113 @@
+//
+// Created by FFZero on 2025-03-08.
+//
+
+#include "Strand.h"
+#include "Util/logger.h"
+#include "Util/onceToken.h"
+
+using namespace std;
+
+namespace FFZKit {
+
+// 当前线程正在执行的Strand
+static thread_local const Strand *s_current_strand = nullptr;
+
+Strand::Ptr Strand::create(TaskExecutor::Ptr executor, size_t max_batch) {
+    if (!executor) {
+        throw std::invalid_argument("Strand executor is empty");
+    }
+    return Ptr(new Strand(std::move(executor), max_batch));
+}
+
+Strand::Strand(TaskExecutor::Ptr executor, size_t max_batch) {
+    executor_ = std::move(executor);
+    max_batch_ = max_batch ? max_batch : 1;
+}
+
+Task::Ptr Strand::async(TaskIn task, bool may_sync) {
+    return async_l(std::move(task), may_sync, false);
+}
+
+Task::Ptr Strand::async_first(TaskIn task, bool may_sync) {
+    return async_l(std::move(task), may_sync, true);
+}
+
+bool Strand::isCurrentThread() const {
+    return s_current_strand == this;
+}
+
+size_t Strand::size() const {
+    lock_guard<mutex> lck(mtx_task_);
+    return list_task_.size();
+}
+
+const TaskExecutor::Ptr &Strand::getExecutor() const {
+    return executor_;
+}
+
+Task::Ptr Strand::async_l(TaskIn task, bool may_sync, bool first) {
+    if (may_sync && isCurrentThread()) {
+        task();
+        return nullptr;
+    }
+    auto task_ptr = std::make_shared<Task>(std::move(task));
+    {
+        lock_guard<mutex> lck(mtx_task_);
+        if (first) {
+            list_task_.emplace_front(task_ptr);
+        } else {
+            list_task_.emplace_back(task_ptr);
+        }
+    }
+    schedule();
+    return task_ptr;
+}
+
+void Strand::schedule() {
+    if (scheduled_.exchange(true)) {
+        // 已经有工作线程负责执行本Strand
+        return;
+    }
+    auto self = shared_from_this();
+    executor_->async([self]() { self->drain(); }, false);
+}
+
+void Strand::drain() {
+    auto last_strand = s_current_strand;
+    s_current_strand = this;
+    // 任务抛出非std::exception的异常时同样恢复状态，否则本Strand再也不会被调度
+    OnceToken token(nullptr, [this, last_strand]() {
+        s_current_strand = last_strand;
+        scheduled_.store(false);
+
+        bool empty;
+        {
+            lock_guard<mutex> lck(mtx_task_);
+            empty = list_task_.empty();
+        }
+        if (!empty) {
+            // 还有剩余任务(或在清除标记前新投递的任务)，重新投递以便让出工作线程
+            schedule();
+        }
+    });
+
+    for (size_t i = 0; i < max_batch_; ++i) {
+        Task::Ptr task;
+        {
+            lock_guard<mutex> lck(mtx_task_);
+            if (list_task_.empty()) {
+                break;
+            }
+            task = std::move(list_task_.front());
+            list_task_.pop_front();
+        }
+        try {
+            (*task)();
+        } catch (std::exception &ex) {
+            ErrorL << "Exception occurred when do strand task: " << ex.what();
+        }
+    }
+}
+
+} // namespace FFZKit
@@ -0,0 +1,72 @@
+//
+// Created by FFZero on 2025-03-08.
+//
+
+#ifndef FFZKIT_STRAND_H_
+#define FFZKIT_STRAND_H_
+
+#include <atomic>
+#include <mutex>
+#include "TaskExecutor.h"
+
+namespace FFZKit {
+
+/**
+ * 串行执行器
+ * 投递到同一个Strand的任务按投递顺序串行执行，但不独占线程，而是借用底层执行器(ThreadPool/EventPoller)的线程
+ * 同一时刻只有一个工作线程在执行某个Strand的任务，由无锁的scheduled标记保证
+ * 适用于大量需要有序执行的逻辑对象(actor)共享少量线程的场景
+ */
+class Strand : public TaskExecutorInterface, public std::enable_shared_from_this<Strand> {
+public:
+    using Ptr = std::shared_ptr<Strand>;
+
+    /**
+     * 创建串行执行器
+     * @param executor 底层执行器，任务最终在其线程上执行
+     * @param max_batch 单次调度最多连续执行的任务个数，超过后重新投递到底层执行器以便让出线程
+     */
+    static Ptr create(TaskExecutor::Ptr executor, size_t max_batch = 64);
+
+    ~Strand() override = default;
+
+    /**
+     * 异步执行任务
+     * @param task 任务
+     * @param may_sync 如果当前线程正在执行本Strand的任务，那么may_sync为true时就是同步执行任务
+     */
+    Task::Ptr async(TaskIn task, bool may_sync = true) override;
+
+    Task::Ptr async_first(TaskIn task, bool may_sync = true) override;
+
+    /**
+     * 当前线程是否正在执行本Strand的任务
+     */
+    bool isCurrentThread() const;
+
+    /**
+     * 待执行的任务个数
+     */
+    size_t size() const;
+
+    const TaskExecutor::Ptr &getExecutor() const;
+
+private:
+    Strand(TaskExecutor::Ptr executor, size_t max_batch);
+
+    Task::Ptr async_l(TaskIn task, bool may_sync, bool first);
+    void schedule();
+    void drain();
+
+private:
+    size_t max_batch_;
+    TaskExecutor::Ptr executor_;
+    // 是否已经投递到底层执行器(或正在执行)
+    std::atomic<bool> scheduled_ { false };
+    mutable std::mutex mtx_task_;
+    List<Task::Ptr> list_task_;
+};
+
+} // namespace FFZKit
+
+#endif //FFZKIT_STRAND_H_
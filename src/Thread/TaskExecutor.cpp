@@ -85,6 +85,14 @@ Task::Ptr TaskExecutorInterface::async_first(TaskIn task, bool may_sync) {
 	return async(task, may_sync);
 }
 
+Task::Ptr TaskExecutorInterface::async_deadline(TaskIn task, uint64_t deadline_ms, bool may_sync) {
+	return async(std::move(task), may_sync);
+}
+
+Task::Ptr TaskExecutorInterface::async_budget(TaskIn task, uint64_t budget_ms, bool may_sync) {
+	return async_deadline(std::move(task), getCurrentMillisecond() + budget_ms, may_sync);
+}
+
 void TaskExecutorInterface::sync(const TaskIn& task) {
 	semaphore sem;
 	auto ret = async([&]() {
@@ -119,6 +127,42 @@ void TaskExecutorInterface::sync_first(const TaskIn& task) {
 
 TaskExecutor::TaskExecutor(uint64_t max_size, uint64_t max_usec): ThreadLoadCounter(max_size, max_usec) {}
 
+void TaskExecutor::getDeadlineStatistic(uint64_t &total, uint64_t &missed) const {
+	total = _deadline_total.load(memory_order_relaxed);
+	missed = _deadline_missed.load(memory_order_relaxed);
+}
+
+void TaskExecutor::enableTaskTrace(bool enable) {
+	_trace_enabled.store(enable, memory_order_relaxed);
+}
+
+TaskTracer &TaskExecutor::getTaskTracer() {
+	return _tracer;
+}
+
+void TaskExecutor::runTracedTask(TracedTask &task) {
+	// 开启追踪前投递的任务没有投递时间，不统计
+	if (!_trace_enabled.load(memory_order_relaxed) || !task.enqueueTime()) {
+		task();
+		return;
+	}
+	auto start = TaskTracer::now();
+	try {
+		task();
+	} catch (...) {
+		_tracer.onTaskDone(task.label(), task.enqueueTime(), start, TaskTracer::now());
+		throw;
+	}
+	_tracer.onTaskDone(task.label(), task.enqueueTime(), start, TaskTracer::now());
+}
+
+void TaskExecutor::onDeadlineTaskDone(uint64_t deadline_ms) {
+	_deadline_total.fetch_add(1, memory_order_relaxed);
+	if (getCurrentMillisecond() > deadline_ms) {
+		_deadline_missed.fetch_add(1, memory_order_relaxed);
+	}
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 
 TaskExecutor::Ptr TaskExecutorGetterImp::getExecutor() {
@@ -6,6 +6,7 @@
 #include <functional>
 #include "Util/List.h"
 #include "Util/util.h"
+#include "TaskTracer.h"
 
 namespace FFZKit {
 
@@ -121,6 +122,28 @@ protected:
 using TaskIn = std::function<void()>;
 using Task = TaskCancelableImp<void()>;
 
+// 携带投递时间和标签的任务，执行器据此统计排队延时和执行耗时
+class TracedTask : public Task {
+public:
+	using Ptr = std::shared_ptr<TracedTask>;
+
+	/**
+	 * @param trace 是否记录投递时间，未开启追踪时不读取时钟
+	 */
+	template<typename FUNC>
+	TracedTask(FUNC &&task, bool trace = true) : Task(std::forward<FUNC>(task)) {
+		_label = TaskTracer::currentLabel();
+		_enqueue_time = trace ? TaskTracer::now() : 0;
+	}
+
+	const char *label() const { return _label; }
+	uint64_t enqueueTime() const { return _enqueue_time; }
+
+private:
+	const char *_label;
+	uint64_t _enqueue_time;
+};
+
 
 class TaskExecutorInterface {
 public:
@@ -143,6 +166,26 @@ public:
 	 */
 	virtual Task::Ptr async_first(TaskIn task, bool may_sync = true);
 
+	/**
+	 * 带截止时间的异步执行任务，待执行任务中截止时间越早越先执行(EDF)
+	 * 普通任务视为没有截止时间，排在带截止时间的任务之后
+	 * 默认实现忽略deadline_ms，等价于async(task, may_sync)；支持截止时间调度的执行器(EventPoller、ThreadPool)需重载
+	 * @param task 任务
+	 * @param deadline_ms 截止时间点，与getCurrentMillisecond()同一时间基准
+	 * @param may_sync 是否允许同步执行该任务
+	 * @return 任务是否添加成功
+	 */
+	virtual Task::Ptr async_deadline(TaskIn task, uint64_t deadline_ms, bool may_sync = true);
+
+	/**
+	 * 带延时预算的异步执行任务，等价于async_deadline(task, getCurrentMillisecond() + budget_ms)
+	 * @param task 任务
+	 * @param budget_ms 允许的最大执行延时，单位毫秒
+	 * @param may_sync 是否允许同步执行该任务
+	 * @return 任务是否添加成功
+	 */
+	Task::Ptr async_budget(TaskIn task, uint64_t budget_ms, bool may_sync = true);
+
 	// 同步执行任务
     void sync(const TaskIn& task);
 
@@ -160,6 +203,42 @@ public:
 	*/
 	TaskExecutor(uint64_t max_size = 32, uint64_t max_usec = 2 * 1000 * 1000);
 	virtual ~TaskExecutor() = default;
+
+	/**
+	 * 获取带截止时间任务的统计
+	 * @param total 已执行的带截止时间任务总数
+	 * @param missed 其中超过截止时间才执行完毕的任务数
+	 */
+	void getDeadlineStatistic(uint64_t &total, uint64_t &missed) const;
+
+	/**
+	 * 是否统计任务的排队延时和执行耗时，默认关闭
+	 * 开启后每个任务多两次读取时钟，并更新各工作线程共享的统计
+	 */
+	void enableTaskTrace(bool enable = true);
+
+	/**
+	 * 获取任务耗时追踪器
+	 */
+	TaskTracer &getTaskTracer();
+
+protected:
+	// 带截止时间的任务执行完毕后调用，统计是否超时
+	void onDeadlineTaskDone(uint64_t deadline_ms);
+
+	// 是否开启任务耗时追踪，用于创建TracedTask
+	bool isTraceEnabled() const { return _trace_enabled.load(std::memory_order_relaxed); }
+
+	/**
+	 * 执行async投递的任务并统计耗时，任务抛出的异常透传给调用者
+	 */
+	void runTracedTask(TracedTask &task);
+
+private:
+	std::atomic<bool> _trace_enabled { false };
+	TaskTracer _tracer;
+	std::atomic<uint64_t> _deadline_total { 0 };
+	std::atomic<uint64_t> _deadline_missed { 0 };
 };
 
 class TaskExecutorGetter {
@@ -5,6 +5,7 @@
 #ifndef FFZKIT_TASKQUEUE_H_
 #define FFZKIT_TASKQUEUE_H_
 
+#include <map>
 #include <mutex>
 #include "Util/List.h"
 #include "semaphore.h"
@@ -33,16 +34,49 @@ public:
         sem_.post();
     }
 
+    //打入带截止时间的任务，截止时间越早越先被取出
+    template<typename C>
+    void push_task_deadline(uint64_t deadline, C&& task_func) {
+        {
+            std::lock_guard<decltype(mutex_)> lock(mutex_);
+            deadline_queue_.emplace(deadline, std::forward<C>(task_func));
+        }
+        sem_.post();
+    }
+
     void push_exit(size_t n) {
         sem_.post(n);
     }
 
     bool get_task(T &task) {
+        bool has_deadline;
+        uint64_t deadline;
+        return get_task(task, has_deadline, deadline);
+    }
+
+    /**
+     * 取出任务，带截止时间的任务优先
+     * @param task 取出的任务
+     * @param has_deadline 是否为带截止时间的任务(截止时间可以为0)
+     * @param deadline 任务截止时间，普通任务为0
+     * @return 是否取到任务，否则说明需要退出
+     */
+    bool get_task(T &task, bool &has_deadline, uint64_t &deadline) {
         sem_.wait();
         std::lock_guard<decltype(mutex_)> lock(mutex_);
+        if (!deadline_queue_.empty()) {
+            auto it = deadline_queue_.begin();
+            has_deadline = true;
+            deadline = it->first;
+            task = std::move(it->second);
+            deadline_queue_.erase(it);
+            return true;
+        }
         if (queue_.empty()) {
             return false;
         }
+        has_deadline = false;
+        deadline = 0;
         task = std::move(queue_.front());
         queue_.pop_front();
         return true;
@@ -50,11 +84,12 @@ public:
 
     size_t size() const {
         std::lock_guard<decltype(mutex_)> lock(mutex_);
-        return queue_.size();
+        return queue_.size() + deadline_queue_.size();
     }
 
 private:
     List<T> queue_;
+    std::multimap<uint64_t, T> deadline_queue_;
     mutable std::mutex mutex_;
     semaphore sem_;
 };
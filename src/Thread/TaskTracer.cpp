@@ -0,0 +1,110 @@
+//
+// Created by FFZero on 2025-03-15.
+//
+
+#include <algorithm>
+#include <chrono>
+#include "TaskTracer.h"
+
+using namespace std;
+
+namespace FFZKit {
+
+static thread_local const char *s_task_label = nullptr;
+
+static bool slowTaskGreater(const TaskTracer::SlowTask &a, const TaskTracer::SlowTask &b) {
+    return a.exec_ns > b.exec_ns;
+}
+
+TaskTracer::TaskTracer(size_t max_slow_task) {
+    _max_slow_task = max_slow_task;
+    _slow_tasks.reserve(max_slow_task);
+}
+
+uint64_t TaskTracer::now() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char *TaskTracer::currentLabel() {
+    return s_task_label;
+}
+
+void TaskTracer::onTaskDone(const char *label, uint64_t enqueue_ns, uint64_t start_ns, uint64_t end_ns) {
+    auto wait_ns = start_ns > enqueue_ns ? start_ns - enqueue_ns : 0;
+    auto exec_ns = end_ns > start_ns ? end_ns - start_ns : 0;
+    _wait.record(wait_ns);
+    _exec.record(exec_ns);
+
+    if (!_max_slow_task || exec_ns <= _slow_threshold.load(memory_order_relaxed)) {
+        // 大部分任务在此返回，不加锁
+        return;
+    }
+
+    lock_guard<mutex> lck(_mtx_slow);
+    SlowTask task { label ? label : "", wait_ns, exec_ns, getCurrentMillisecond() };
+    if (_slow_tasks.size() < _max_slow_task) {
+        _slow_tasks.emplace_back(task);
+        push_heap(_slow_tasks.begin(), _slow_tasks.end(), slowTaskGreater);
+    } else if (exec_ns > _slow_tasks.front().exec_ns) {
+        pop_heap(_slow_tasks.begin(), _slow_tasks.end(), slowTaskGreater);
+        _slow_tasks.back() = task;
+        push_heap(_slow_tasks.begin(), _slow_tasks.end(), slowTaskGreater);
+    }
+    if (_slow_tasks.size() >= _max_slow_task) {
+        _slow_threshold.store(_slow_tasks.front().exec_ns, memory_order_relaxed);
+    }
+}
+
+const Histogram &TaskTracer::getWaitHistogram() const {
+    return _wait;
+}
+
+const Histogram &TaskTracer::getExecHistogram() const {
+    return _exec;
+}
+
+vector<TaskTracer::SlowTask> TaskTracer::getSlowTasks() const {
+    vector<SlowTask> ret;
+    {
+        lock_guard<mutex> lck(_mtx_slow);
+        ret = _slow_tasks;
+    }
+    sort(ret.begin(), ret.end(), slowTaskGreater);
+    return ret;
+}
+
+void TaskTracer::reset() {
+    _wait.reset();
+    _exec.reset();
+    lock_guard<mutex> lck(_mtx_slow);
+    _slow_tasks.clear();
+    _slow_threshold.store(0, memory_order_relaxed);
+}
+
+string TaskTracer::dump() const {
+    static auto to_us = [](uint64_t ns) { return ns / 1000; };
+    _StrPrinter printer;
+    auto &wait = getWaitHistogram();
+    auto &exec = getExecHistogram();
+    printer << "tasks:" << exec.count()
+            << " | wait p50:" << to_us(wait.percentile(50)) << "us p99:" << to_us(wait.percentile(99))
+            << "us p99.9:" << to_us(wait.percentile(99.9)) << "us max:" << to_us(wait.max()) << "us"
+            << " | exec p50:" << to_us(exec.percentile(50)) << "us p99:" << to_us(exec.percentile(99))
+            << "us p99.9:" << to_us(exec.percentile(99.9)) << "us max:" << to_us(exec.max()) << "us";
+    for (auto &task : getSlowTasks()) {
+        printer << "\n    slow task [" << (*task.label ? task.label : "unlabeled") << "] exec:" << to_us(task.exec_ns)
+                << "us wait:" << to_us(task.wait_ns) << "us at:" << task.stamp;
+    }
+    return std::move(printer);
+}
+
+TaskLabel::TaskLabel(const char *label) {
+    _last = s_task_label;
+    s_task_label = label;
+}
+
+TaskLabel::~TaskLabel() {
+    s_task_label = _last;
+}
+
+} // namespace FFZKit
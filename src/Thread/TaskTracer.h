@@ -0,0 +1,98 @@
+//
+// Created by FFZero on 2025-03-15.
+//
+
+#ifndef FFZKIT_TASKTRACER_H_
+#define FFZKIT_TASKTRACER_H_
+
+#include <mutex>
+#include <vector>
+#include "Util/Histogram.h"
+
+namespace FFZKit {
+
+/**
+ * 任务耗时追踪器
+ * 统计通过async投递的任务的排队延时(投递->开始执行)和执行耗时(开始->结束)，单位纳秒
+ * 并记录执行耗时最长的若干个任务及其标签
+ */
+class TaskTracer : public noncopyable {
+public:
+    class SlowTask {
+    public:
+        // 任务标签，见TaskLabel
+        const char *label;
+        // 排队延时，单位纳秒
+        uint64_t wait_ns;
+        // 执行耗时，单位纳秒
+        uint64_t exec_ns;
+        // 执行结束时间点，getCurrentMillisecond()
+        uint64_t stamp;
+    };
+
+    TaskTracer(size_t max_slow_task = 16);
+    ~TaskTracer() = default;
+
+    /**
+     * 单调时钟，单位纳秒
+     */
+    static uint64_t now();
+
+    /**
+     * 获取当前线程设置的任务标签，见TaskLabel
+     */
+    static const char *currentLabel();
+
+    /**
+     * 记录一个任务的执行情况
+     * @param label 任务标签
+     * @param enqueue_ns 投递时间
+     * @param start_ns 开始执行时间
+     * @param end_ns 执行结束时间
+     */
+    void onTaskDone(const char *label, uint64_t enqueue_ns, uint64_t start_ns, uint64_t end_ns);
+
+    // 排队延时分布
+    const Histogram &getWaitHistogram() const;
+    // 执行耗时分布
+    const Histogram &getExecHistogram() const;
+
+    /**
+     * 获取执行耗时最长的任务列表，按耗时从大到小排序
+     */
+    std::vector<SlowTask> getSlowTasks() const;
+
+    void reset();
+
+    /**
+     * 打印统计摘要(单位微秒)
+     */
+    std::string dump() const;
+
+private:
+    size_t _max_slow_task;
+    std::atomic<uint64_t> _slow_threshold { 0 };
+    mutable std::mutex _mtx_slow;
+    // 小顶堆，堆顶为已记录的慢任务中耗时最短的
+    std::vector<SlowTask> _slow_tasks;
+    Histogram _wait;
+    Histogram _exec;
+};
+
+/**
+ * 任务标签作用域，作用域内本线程通过async投递的任务都会带上该标签
+ * 标签指针会被保存，请传入字符串常量
+ * 用法: { TaskLabel label("rtp relay"); poller->async(...); }
+ */
+class TaskLabel : public noncopyable {
+public:
+    explicit TaskLabel(const char *label);
+    ~TaskLabel();
+
+private:
+    const char *_last;
+};
+
+} // namespace FFZKit
+
+#endif //FFZKIT_TASKTRACER_H_
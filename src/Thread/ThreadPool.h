@@ -10,6 +10,7 @@
 #include "TaskQueue.h"
 #include "Util/util.h"
 #include "Util/logger.h"
+#include "Util/onceToken.h"
 
 namespace FFZKit {
 
@@ -52,7 +53,7 @@ public:
             task();
             return nullptr;
         }
-        auto ret = std::make_shared<Task>(std::move(task));
+        auto ret = std::make_shared<TracedTask>(std::move(task), isTraceEnabled());
         task_queue_.push_task(ret);
         return ret;
     }
@@ -63,11 +64,23 @@ public:
             return nullptr;
         }
 
-        auto ret = std::make_shared<Task>(std::move(task));
+        auto ret = std::make_shared<TracedTask>(std::move(task), isTraceEnabled());
         task_queue_.push_task_first(ret);
         return ret;
     }
 
+    Task::Ptr async_deadline(TaskIn task, uint64_t deadline_ms, bool may_sync = true) override {
+        if (may_sync && thread_group_.is_this_thread_in()) {
+            // 任务抛异常时也需统计截止时间
+            OnceToken token(nullptr, [&]() { onDeadlineTaskDone(deadline_ms); });
+            task();
+            return nullptr;
+        }
+
+        auto ret = std::make_shared<TracedTask>(std::move(task), isTraceEnabled());
+        task_queue_.push_task_deadline(deadline_ms, ret);
+        return ret;
+    }
 
     void start() {
         if (thread_num_ <= 0) {
@@ -116,20 +129,25 @@ public:
 private:
     void run(size_t index) {
         on_setup_(index);
-        Task::Ptr task;
+        TracedTask::Ptr task;
+        bool has_deadline;
+        uint64_t deadline;
         while (true) {
             startSleep();
-            if (!task_queue_.get_task(task)) {
+            if (!task_queue_.get_task(task, has_deadline, deadline)) {
                 //空任务，退出线程
                 break;
             }
             sleepWakeUp();
             try {
-                (*task)();
+                runTracedTask(*task);
                 task = nullptr;
             } catch (std::exception &ex) {
                 ErrorL << "ThreadPool catch a exception: " << ex.what();
             }
+            if (has_deadline) {
+                onDeadlineTaskDone(deadline);
+            }
         }
     }
 
@@ -145,7 +163,7 @@ private:
     size_t thread_num_;
     Logger::Ptr logger_;
     ThreadGroup thread_group_;
-    TaskQueue<Task::Ptr> task_queue_;
+    TaskQueue<TracedTask::Ptr> task_queue_;
     std::function<void(int)> on_setup_;
 };
 
@@ -177,7 +177,7 @@ public:
 
     void operator()(int argc, char* argv[], const std::shared_ptr<std::ostream>& stream = nullptr) {
         this->clear();
-        std::shared_ptr<std::ostream> coutPtr(&std::cout);
+        std::shared_ptr<std::ostream> coutPtr(&std::cout, [](std::ostream *) {});
         (*_parser)(*this, argc, argv, stream ? stream : coutPtr);
     }
 
@@ -259,7 +259,7 @@ public:
     void printHelp(const std::shared_ptr<std::ostream> &streamTmp = nullptr) {
         auto stream = streamTmp;
         if (!stream) {
-            stream.reset(&std::cout);
+            stream.reset(&std::cout, [](std::ostream *) {});
         }
         std::lock_guard<std::recursive_mutex> lck(_mtx);
         size_t maxLen = 0;
@@ -0,0 +1,113 @@
+//
+// Created by FFZero on 2025-03-15.
+//
+
+#include "Histogram.h"
+
+using namespace std;
+
+namespace FFZKit {
+
+Histogram::Histogram() {
+    reset();
+}
+
+size_t Histogram::bucketIndex(uint64_t value) {
+    if (value < (1ULL << kSubBits)) {
+        return (size_t)value;
+    }
+    int msb = 63;
+    while (!(value >> msb)) {
+        --msb;
+    }
+    // 保留最高的kSubBits位，其余位作为区间指数
+    auto shift = msb - kSubBits + 1;
+    return (size_t)shift * kHalfBucket + (size_t)(value >> shift);
+}
+
+uint64_t Histogram::bucketUpper(size_t index) {
+    if (index < (1ULL << kSubBits)) {
+        return index;
+    }
+    auto shift = index / kHalfBucket - 1;
+    auto sub = index - shift * kHalfBucket;
+    return ((sub + 1) << shift) - 1;
+}
+
+void Histogram::record(uint64_t value) {
+    _buckets[bucketIndex(value)].fetch_add(1, memory_order_relaxed);
+    _count.fetch_add(1, memory_order_relaxed);
+    _sum.fetch_add(value, memory_order_relaxed);
+    auto max = _max.load(memory_order_relaxed);
+    while (value > max && !_max.compare_exchange_weak(max, value, memory_order_relaxed));
+}
+
+void Histogram::merge(const Histogram &other) {
+    for (int i = 0; i < kBucketCount; ++i) {
+        auto n = other._buckets[i].load(memory_order_relaxed);
+        if (n) {
+            _buckets[i].fetch_add(n, memory_order_relaxed);
+        }
+    }
+    _count.fetch_add(other.count(), memory_order_relaxed);
+    _sum.fetch_add(other._sum.load(memory_order_relaxed), memory_order_relaxed);
+    auto value = other.max();
+    auto max = _max.load(memory_order_relaxed);
+    while (value > max && !_max.compare_exchange_weak(max, value, memory_order_relaxed));
+}
+
+void Histogram::reset() {
+    for (auto &bucket : _buckets) {
+        bucket.store(0, memory_order_relaxed);
+    }
+    _count.store(0, memory_order_relaxed);
+    _sum.store(0, memory_order_relaxed);
+    _max.store(0, memory_order_relaxed);
+}
+
+uint64_t Histogram::count() const {
+    return _count.load(memory_order_relaxed);
+}
+
+uint64_t Histogram::max() const {
+    return _max.load(memory_order_relaxed);
+}
+
+uint64_t Histogram::mean() const {
+    auto count = this->count();
+    return count ? _sum.load(memory_order_relaxed) / count : 0;
+}
+
+uint64_t Histogram::percentile(double percent) const {
+    auto count = this->count();
+    if (!count) {
+        return 0;
+    }
+    auto target = (uint64_t)(count * percent / 100.0);
+    if (target == 0) {
+        target = 1;
+    }
+    uint64_t total = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        total += _buckets[i].load(memory_order_relaxed);
+        if (total >= target) {
+            auto upper = bucketUpper(i);
+            return upper < max() ? upper : max();
+        }
+    }
+    return max();
+}
+
+string Histogram::dump(const char *unit) const {
+    _StrPrinter printer;
+    printer << "count:" << count()
+            << " mean:" << mean() << unit
+            << " p50:" << percentile(50) << unit
+            << " p90:" << percentile(90) << unit
+            << " p99:" << percentile(99) << unit
+            << " p99.9:" << percentile(99.9) << unit
+            << " max:" << max() << unit;
+    return std::move(printer);
+}
+
+} // namespace FFZKit
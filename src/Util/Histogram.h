@@ -0,0 +1,66 @@
+//
+// Created by FFZero on 2025-03-15.
+//
+
+#ifndef FFZKIT_HISTOGRAM_H
+#define FFZKIT_HISTOGRAM_H
+
+#include <atomic>
+#include <string>
+#include "util.h"
+
+namespace FFZKit {
+
+/**
+ * HDR风格的对数-线性直方图，用于统计延时等分布
+ * 每个2的幂区间再等分为16个子桶，相对误差约6%，可覆盖0~2^64全范围
+ * 写入只有relaxed原子操作，可多线程并发record
+ */
+class Histogram : public noncopyable {
+public:
+    Histogram();
+    ~Histogram() = default;
+
+    // 记录一个样本
+    void record(uint64_t value);
+
+    // 合并另一个直方图的样本
+    void merge(const Histogram &other);
+
+    void reset();
+
+    uint64_t count() const;
+    uint64_t max() const;
+    uint64_t mean() const;
+
+    /**
+     * 获取百分位数
+     * @param percent 百分比，范围0~100，例如99.9
+     * @return 该百分位样本所在桶的上界
+     */
+    uint64_t percentile(double percent) const;
+
+    /**
+     * 打印p50/p90/p99/p99.9/max等摘要
+     * @param unit 数值单位，仅用于打印
+     */
+    std::string dump(const char *unit = "") const;
+
+private:
+    static constexpr int kSubBits = 5;
+    static constexpr int kHalfBucket = 1 << (kSubBits - 1);
+    static constexpr int kBucketCount = (64 - kSubBits + 1) * kHalfBucket + kHalfBucket * 2;
+
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketUpper(size_t index);
+
+private:
+    std::atomic<uint64_t> _count;
+    std::atomic<uint64_t> _sum;
+    std::atomic<uint64_t> _max;
+    std::atomic<uint64_t> _buckets[kBucketCount];
+};
+
+} // namespace FFZKit
+
+#endif //FFZKIT_HISTOGRAM_H
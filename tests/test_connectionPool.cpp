@@ -0,0 +1,106 @@
+//
+// Created by FFZero on 2025-07-05.
+//
+
+#include "Util/logger.h"
+#include "Util/TimeTicker.h"
+#include "Thread/semaphore.h"
+#include "Network/TcpServer.h"
+#include "Network/ConnectionPool.h"
+
+using namespace std;
+using namespace FFZKit;
+
+//客户端连接池：预连接、串行请求复用同一批连接、并发请求时新建连接、空闲超时淘汰到最少空闲数、服务器关闭后空闲连接被丢弃
+static const size_t kMinIdle = 4;
+static const size_t kMaxIdle = 8;
+static const size_t kSerialRequests = 100;
+static const size_t kConcurrentRequests = 16;
+
+class EchoSession : public Session {
+public:
+    EchoSession(const Socket::Ptr &sock) : Session(sock) {}
+
+    void onRecv(const Buffer::Ptr &buf) override {
+        send(buf);
+    }
+
+    void onError(const SockException &err) override {}
+};
+
+static void dump(const char *stage, const ConnectionPool::Ptr &pool) {
+    auto stat = pool->getStatistic();
+    InfoL << stage << ", created: " << stat.created << ", reused: " << stat.reused << ", evicted: " << stat.evicted
+          << ", invalid: " << stat.invalid << ", idle: " << stat.idle;
+}
+
+//从连接池获取连接，发送请求并等待回显，完成后释放连接
+static void request(const ConnectionPool::Ptr &pool, uint16_t port, semaphore &sem) {
+    pool->get("127.0.0.1", port, [&sem](const SockException &err, const Socket::Ptr &sock) {
+        if (err) {
+            ErrorL << "get connection failed: " << err;
+            sem.post();
+            return;
+        }
+        //回调中不能强引用连接，通过holder在收到回显后释放
+        auto holder = std::make_shared<Socket::Ptr>(sock);
+        weak_ptr<Socket::Ptr> weak_holder = holder;
+        sock->setOnRead([&sem, weak_holder](Buffer::Ptr &buf, struct sockaddr *, int) {
+            if (auto strong_holder = weak_holder.lock()) {
+                *strong_holder = nullptr;
+                sem.post();
+            }
+        });
+        sock->send("ping");
+        //holder由poller上的延时任务持有到回显为止
+        sock->getPoller()->doDelayTask(3000, [holder]() { return 0; });
+    });
+}
+
+int main() {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+    Logger::Instance().setWriter(std::make_shared<AsyncLogWriter>());
+    Logger::Instance().setLevel(LInfo);
+
+    auto server = std::make_shared<TcpServer>();
+    if (!server->start<EchoSession>(0, "127.0.0.1")) {
+        ErrorL << "start tcp server failed";
+        return -1;
+    }
+    auto port = server->getPort();
+
+    auto pool = std::make_shared<ConnectionPool>(EventPollerPool::Instance().getPoller());
+    pool->setMaxIdle(kMaxIdle);
+    pool->setIdleTimeout(2);
+    pool->setMinIdle("127.0.0.1", port, kMinIdle);
+    this_thread::sleep_for(chrono::milliseconds(200));
+    dump("after pre-warm", pool);
+
+    semaphore sem;
+    Ticker ticker;
+    for (size_t i = 0; i < kSerialRequests; ++i) {
+        request(pool, port, sem);
+        sem.wait();
+    }
+    InfoL << kSerialRequests << " serial requests in " << ticker.elapsedTime() << "ms";
+    this_thread::sleep_for(chrono::milliseconds(100));
+    dump("after serial requests", pool);
+
+    for (size_t i = 0; i < kConcurrentRequests; ++i) {
+        request(pool, port, sem);
+    }
+    for (size_t i = 0; i < kConcurrentRequests; ++i) {
+        sem.wait();
+    }
+    this_thread::sleep_for(chrono::milliseconds(100));
+    dump("after concurrent requests", pool);
+
+    this_thread::sleep_for(chrono::milliseconds(3500));
+    dump("after idle timeout", pool);
+
+    server = nullptr;
+    this_thread::sleep_for(chrono::milliseconds(500));
+    dump("after server destroyed", pool);
+    pool = nullptr;
+    return 0;
+}
@@ -0,0 +1,69 @@
+//
+// Created by FFZero on 2025-03-02.
+//
+
+#include "Util/logger.h"
+#include "Util/TimeTicker.h"
+#include "Thread/semaphore.h"
+#include "Poller/PipeWrap.h"
+#include "Poller/Coroutine.h"
+
+using namespace std;
+using namespace FFZKit;
+
+#if defined(ENABLE_COROUTINE)
+
+static CoTask<int> readPipe(PipeWrap &pipe) {
+    auto event = co_await readable(pipe.readFD());
+    char buf[64] = {0};
+    auto size = pipe.read(buf, sizeof(buf) - 1);
+    InfoL << "pipe readable, event: " << event << ", data: " << buf;
+    co_return size;
+}
+
+static CoTask<> run(semaphore &sem) {
+    auto poller0 = EventPollerPool::Instance().getPoller(false);
+    auto poller1 = EventPollerPool::Instance().getPoller(false);
+
+    co_await poller0;
+    InfoL << "switched to " << EventPoller::getCurrentPoller()->getThreadName();
+
+    Ticker ticker;
+    co_await delay(100);
+    InfoL << "delay 100ms, elapsed: " << ticker.elapsedTime() << "ms";
+
+    PipeWrap pipe;
+    thread writer([&pipe]() {
+        this_thread::sleep_for(chrono::milliseconds(50));
+        pipe.write("hello coroutine", sizeof("hello coroutine"));
+    });
+    auto size = co_await readPipe(pipe);
+    writer.join();
+    InfoL << "read pipe size: " << size;
+
+    co_await poller1;
+    InfoL << "switched to " << EventPoller::getCurrentPoller()->getThreadName()
+          << ", cached frames: " << CoFramePool::freeCount();
+    sem.post();
+}
+
+int main() {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+    Logger::Instance().setWriter(std::make_shared<AsyncLogWriter>());
+
+    semaphore sem;
+    run(sem).start();
+    sem.wait();
+    InfoL << "done!";
+    return 0;
+}
+
+#else
+
+int main() {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+    WarnL << "coroutine support is disabled, please build with -DENABLE_COROUTINE=ON";
+    return 0;
+}
+
+#endif // defined(ENABLE_COROUTINE)
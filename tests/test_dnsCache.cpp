@@ -0,0 +1,86 @@
+//
+// Created by FFZero on 2025-07-05.
+//
+
+#include <thread>
+#include "Util/logger.h"
+#include "Util/TimeTicker.h"
+#include "Network/sockutil.h"
+
+using namespace std;
+using namespace FFZKit;
+
+//dns缓存：有效期后段后台刷新，过期后仍返回旧结果；解析失败的结果同样缓存；多线程并发查询
+static const int kExpireSec = 1;
+static const size_t kThreadCount = 8;
+static const size_t kLookupPerThread = 100000;
+
+static void dump(const char *stage) {
+    auto stat = SockUtil::getDnsStatistic();
+    InfoL << stage << ", hit: " << stat.hit << ", stale hit: " << stat.stale_hit << ", negative hit: " << stat.negative_hit
+          << ", miss: " << stat.miss << ", refresh: " << stat.refresh;
+}
+
+int main(int argc, char *argv[]) {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+    Logger::Instance().setWriter(std::make_shared<AsyncLogWriter>());
+
+    string host = argc > 1 ? argv[1] : "localhost";
+    struct sockaddr_storage addr;
+    SockUtil::getDomainIP(host.data(), 80, addr, AF_INET, SOCK_STREAM, IPPROTO_TCP, kExpireSec);
+    dump("first lookup");
+
+    //超过3/4有效期，返回缓存并触发后台刷新
+    this_thread::sleep_for(chrono::milliseconds(kExpireSec * 800));
+    SockUtil::getDomainIP(host.data(), 80, addr, AF_INET, SOCK_STREAM, IPPROTO_TCP, kExpireSec);
+    this_thread::sleep_for(chrono::milliseconds(100));
+    dump("lookup near expiry");
+
+    //刷新后的结果仍在有效期内
+    this_thread::sleep_for(chrono::milliseconds(kExpireSec * 500));
+    SockUtil::getDomainIP(host.data(), 80, addr, AF_INET, SOCK_STREAM, IPPROTO_TCP, kExpireSec);
+    dump("lookup after refresh");
+
+    //过期后一个有效期内返回旧结果，同时后台刷新
+    this_thread::sleep_for(chrono::milliseconds(kExpireSec * 700));
+    SockUtil::getDomainIP(host.data(), 80, addr, AF_INET, SOCK_STREAM, IPPROTO_TCP, kExpireSec);
+    this_thread::sleep_for(chrono::milliseconds(100));
+    dump("lookup after expiry");
+
+    for (int i = 0; i < 3; ++i) {
+        SockUtil::getDomainIP("not-exist.invalid", 80, addr);
+    }
+    dump("lookup invalid domain 3 times");
+
+    //多个线程同时查询未缓存的域名，只解析一次，其余线程等待其结果
+    {
+        vector<thread> threads;
+        for (size_t i = 0; i < kThreadCount; ++i) {
+            threads.emplace_back([]() {
+                struct sockaddr_storage addr;
+                SockUtil::getDomainIP("another-not-exist.invalid", 80, addr);
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+    }
+    dump("concurrent lookup of uncached invalid domain");
+
+    Ticker ticker;
+    vector<thread> threads;
+    for (size_t i = 0; i < kThreadCount; ++i) {
+        threads.emplace_back([&host]() {
+            struct sockaddr_storage addr;
+            for (size_t j = 0; j < kLookupPerThread; ++j) {
+                SockUtil::getDomainIP(host.data(), 80, addr);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    InfoL << kThreadCount * kLookupPerThread << " lookups from " << kThreadCount << " threads in " << ticker.elapsedTime() << "ms";
+    dump("concurrent lookup");
+    return 0;
+}
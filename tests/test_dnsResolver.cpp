@@ -0,0 +1,72 @@
+//
+// Created by FFZero on 2025-07-05.
+//
+
+#include "Util/logger.h"
+#include "Util/TimeTicker.h"
+#include "Thread/semaphore.h"
+#include "Network/DnsResolver.h"
+
+using namespace std;
+using namespace FFZKit;
+
+//异步dns解析：同一域名的并发请求合并为一次解析，结果在发起请求的poller线程回调；以域名连接时不阻塞poller
+static const size_t kRequestCount = 100;
+
+int main(int argc, char *argv[]) {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+    Logger::Instance().setWriter(std::make_shared<AsyncLogWriter>());
+
+    //可通过参数指定待解析域名，默认使用/etc/hosts中的localhost
+    string host = argc > 1 ? argv[1] : "localhost";
+    auto poller = EventPollerPool::Instance().getPoller();
+    semaphore sem;
+    auto done = std::make_shared<size_t>(0);
+    auto wrong_thread = std::make_shared<size_t>(0);
+
+    Ticker ticker;
+    for (size_t i = 0; i < kRequestCount; ++i) {
+        DnsResolver::Instance().resolve(host, 80, poller, [&sem, poller, done, wrong_thread, host](const SockException &err, const struct sockaddr_storage &addr) {
+            if (!poller->isCurrentThread()) {
+                ++*wrong_thread;
+            }
+            if (++*done == 1) {
+                InfoL << host << " -> " << (err ? err.what() : SockUtil::inet_ntoa((struct sockaddr *)&addr)) << ":"
+                      << (err ? 0 : SockUtil::inet_port((struct sockaddr *)&addr));
+            }
+            if (*done == kRequestCount) {
+                sem.post();
+            }
+        });
+    }
+    InfoL << "pending domains after " << kRequestCount << " requests: " << DnsResolver::Instance().pendingCount();
+    sem.wait();
+    InfoL << "resolved " << kRequestCount << " requests in " << ticker.elapsedTime() << "ms, callbacks off poller thread: " << *wrong_thread;
+
+    //解析不存在的域名期间poller仍可执行任务
+    ticker.resetTime();
+    DnsResolver::Instance().resolve("not-exist.invalid", 80, poller, [&sem](const SockException &err, const struct sockaddr_storage &) {
+        InfoL << "resolve not-exist.invalid: " << err;
+        sem.post();
+    });
+    poller->sync([]() {});
+    InfoL << "poller responded in " << ticker.elapsedTime() << "ms while resolving";
+    sem.wait();
+
+    //以域名连接
+    auto server = Socket::createSocket(poller);
+    server->setOnAccept([](Socket::Ptr &) {});
+    if (!server->listen(0, "127.0.0.1")) {
+        ErrorL << "listen failed";
+        return -1;
+    }
+    auto client = Socket::createSocket(poller);
+    client->connect(host, server->get_local_port(), [&sem](const SockException &err) {
+        InfoL << "connect result: " << err;
+        sem.post();
+    });
+    sem.wait();
+    client = nullptr;
+    server = nullptr;
+    return 0;
+}
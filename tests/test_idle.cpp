@@ -0,0 +1,55 @@
+//
+// Created by FFZero on 2025-05-10.
+//
+
+#include "Util/logger.h"
+#include "Util/TimeTicker.h"
+#include "Thread/semaphore.h"
+#include "Poller/EventPoller.h"
+
+using namespace std;
+using namespace FFZKit;
+
+int main() {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+    Logger::Instance().setWriter(std::make_shared<AsyncLogWriter>());
+
+    auto poller = EventPollerPool::Instance().getPoller(false);
+    //空闲时每50ms执行一次，繁忙时最多推迟500ms
+    poller->setIdleParam(50, 500, 1000);
+
+    atomic<int> idle_count { 0 };
+    auto idle_task = poller->onIdle([&idle_count]() {
+        //模拟内存池收缩、日志刷新等维护工作
+        ++idle_count;
+        return true;
+    });
+
+    //空闲阶段，空闲回调按间隔执行
+    this_thread::sleep_for(chrono::seconds(1));
+    InfoL << "idle phase, idle task run times: " << idle_count;
+
+    //繁忙阶段，持续投递任务使事件循环一直没有机会休眠，空闲回调被推迟
+    idle_count = 0;
+    atomic<bool> busy { true };
+    Ticker ticker;
+    thread producer([&]() {
+        while (busy) {
+            semaphore sem;
+            for (int i = 0; i < 1000; ++i) {
+                poller->async([]() {
+                    this_thread::sleep_for(chrono::microseconds(10));
+                }, false);
+            }
+            poller->async([&sem]() { sem.post(); }, false);
+            sem.wait();
+        }
+    });
+    this_thread::sleep_for(chrono::seconds(1));
+    busy = false;
+    producer.join();
+    InfoL << "busy phase, idle task run times: " << idle_count;
+
+    idle_task->cancel();
+    return 0;
+}
@@ -0,0 +1,70 @@
+//
+// Created by FFZero on 2025-07-05.
+//
+
+#include "Util/logger.h"
+#include "Poller/EventPoller.h"
+
+using namespace std;
+using namespace FFZKit;
+
+//按key分派poller：相同的key总是映射到同一个poller；poller个数变化时，取模会迁移大部分key，rendezvous hash只迁移约1/(n+1)的key
+static const size_t kPollerCount = 4;
+static const uint64_t kKeyCount = 100000;
+
+static void checkRemap(bool rendezvous) {
+    size_t moved = 0;
+    size_t moved_to_new = 0;
+    for (uint64_t key = 0; key < kKeyCount; ++key) {
+        auto before = EventPollerPool::getIndexForKey(key, kPollerCount, rendezvous);
+        auto after = EventPollerPool::getIndexForKey(key, kPollerCount + 1, rendezvous);
+        if (before != after) {
+            ++moved;
+            if (after == kPollerCount) {
+                ++moved_to_new;
+            }
+        }
+    }
+    InfoL << (rendezvous ? "rendezvous hash" : "modulo") << ", poller " << kPollerCount << " -> " << kPollerCount + 1
+          << ", moved keys: " << moved * 100.0 / kKeyCount << "%, moved to the new poller: " << moved_to_new;
+}
+
+int main() {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+    Logger::Instance().setWriter(std::make_shared<AsyncLogWriter>());
+
+    EventPollerPool::setPoolSize(kPollerCount);
+    auto &pool = EventPollerPool::Instance();
+
+    for (int i = 0; i < 2; ++i) {
+        pool.enableRendezvousHash(i == 1);
+        size_t unstable = 0;
+        vector<size_t> dist(kPollerCount);
+        for (uint64_t key = 0; key < kKeyCount; ++key) {
+            auto poller = pool.getPollerForKey(key);
+            if (poller != pool.getPollerForKey(key)) {
+                ++unstable;
+            }
+            ++dist[EventPollerPool::getIndexForKey(key, kPollerCount, i == 1)];
+        }
+        if (pool.getPollerForKey("stream/live/1") != pool.getPollerForKey(string("stream/live/1"))) {
+            ++unstable;
+        }
+        _StrPrinter printer;
+        for (auto n : dist) {
+            printer << n << " ";
+        }
+        InfoL << (i == 1 ? "rendezvous hash" : "modulo") << ", unstable keys: " << unstable << ", distribution: " << printer;
+    }
+
+    //同一key的任务在同一poller上按投递顺序执行
+    auto poller = pool.getPollerForKey("session-1");
+    pool.asyncKeyed("session-1", [poller]() {
+        InfoL << "keyed task runs on the expected poller: " << (EventPoller::getCurrentPoller() == poller);
+    });
+    poller->sync([]() {});
+
+    checkRemap(false);
+    checkRemap(true);
+    return 0;
+}
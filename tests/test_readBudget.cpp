@@ -0,0 +1,94 @@
+//
+// Created by FFZero on 2025-05-03.
+//
+
+#include <sys/socket.h>
+#include "Util/logger.h"
+#include "Thread/semaphore.h"
+#include "Network/sockutil.h"
+#include "Poller/EventPoller.h"
+
+using namespace std;
+using namespace FFZKit;
+
+//两个高负载fd和一个低负载fd，回调每次最多读取16KB，观察低负载fd是否被及时处理
+static const size_t kReadBudget = 16 * 1024;
+
+class Reader {
+public:
+    Reader(string name) : name(std::move(name)) {
+        socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+        SockUtil::setNoBlocked(fds[0]);
+        SockUtil::setNoBlocked(fds[1]);
+        SockUtil::setSendBuf(fds[1], 4 * 1024 * 1024);
+        SockUtil::setRecvBuf(fds[0], 4 * 1024 * 1024);
+    }
+
+    ~Reader() {
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    void write(size_t size) {
+        string data(size, 'x');
+        auto ret = ::send(fds[1], data.data(), data.size(), 0);
+        InfoL << name << " written " << ret << " bytes";
+    }
+
+    //返回true代表本次读满了预算，可能还有数据
+    bool onRead() {
+        char buf[4096];
+        size_t total = 0;
+        while (total < kReadBudget) {
+            auto ret = ::recv(fds[0], buf, sizeof(buf), 0);
+            if (ret <= 0) {
+                break;
+            }
+            total += ret;
+        }
+        ++calls;
+        bytes += total;
+        if (total < kReadBudget) {
+            InfoL << name << " drained " << bytes << " bytes in " << calls << " callbacks";
+        }
+        return total >= kReadBudget;
+    }
+
+    string name;
+    int fds[2];
+    size_t calls = 0;
+    size_t bytes = 0;
+};
+
+int main() {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+    Logger::Instance().setWriter(std::make_shared<AsyncLogWriter>());
+
+    auto poller = EventPollerPool::Instance().getPoller(false);
+    Reader hot0("hot fd 0"), hot1("hot fd 1"), cold("cold fd");
+    hot0.write(1024 * 1024);
+    hot1.write(1024 * 1024);
+    cold.write(100);
+
+    //两个高负载fd交替读取，低负载fd在第一轮就被处理，而不是等某个高负载fd读空之后
+    semaphore sem;
+    poller->async([&]() {
+        for (auto reader : { &hot0, &hot1, &cold }) {
+            poller->addBudgetEvent(reader->fds[0], EventPoller::Event_Read, [reader](int event) {
+                return reader->onRead();
+            });
+        }
+        sem.post();
+    });
+    sem.wait();
+
+    this_thread::sleep_for(chrono::milliseconds(500));
+    poller->async([&]() {
+        for (auto reader : { &hot0, &hot1, &cold }) {
+            poller->delEvent(reader->fds[0]);
+        }
+        sem.post();
+    });
+    sem.wait();
+    return 0;
+}
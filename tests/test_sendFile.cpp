@@ -0,0 +1,110 @@
+//
+// Created by FFZero on 2025-06-21.
+//
+
+#include "Util/logger.h"
+#include "Util/TimeTicker.h"
+#include "Thread/semaphore.h"
+#include "Network/Socket.h"
+
+using namespace std;
+using namespace FFZKit;
+
+//文件区间发送：文件内容不读入内存，与前后send的数据按顺序到达；接收端暂停接收后关闭连接，未发送完的文件回调取消
+static const char *kFilePath = "test_sendFile.bin";
+static const size_t kFileSize = 32 * 1024 * 1024;
+static const size_t kRegionOffset = 1000;
+static const size_t kRegionSize = 20 * 1024 * 1024;
+static const string kHeader(16, 'h');
+static const string kTrailer(16, 't');
+
+//接收到的第pos个字节应有的值
+static char expected(size_t pos) {
+    if (pos < kHeader.size()) {
+        return kHeader[pos];
+    }
+    pos -= kHeader.size();
+    if (pos < kRegionSize) {
+        return (char)((kRegionOffset + pos) % 251);
+    }
+    return kTrailer[pos - kRegionSize];
+}
+
+int main() {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+    Logger::Instance().setWriter(std::make_shared<AsyncLogWriter>());
+
+    {
+        auto fp = fopen(kFilePath, "wb");
+        string block(1024 * 1024, '\0');
+        for (size_t offset = 0; offset < kFileSize; offset += block.size()) {
+            for (size_t i = 0; i < block.size(); ++i) {
+                block[i] = (char)((offset + i) % 251);
+            }
+            fwrite(block.data(), 1, block.size(), fp);
+        }
+        fclose(fp);
+    }
+
+    auto poller = EventPollerPool::Instance().getPoller();
+    semaphore sem;
+    auto total = kHeader.size() + kRegionSize + kTrailer.size();
+    auto received = std::make_shared<size_t>(0);
+    auto bad = std::make_shared<size_t>(0);
+    auto session = std::make_shared<Socket::Ptr>();
+    auto server = Socket::createSocket(poller);
+    server->setOnAccept([&sem, total, received, bad, session](Socket::Ptr &sock) {
+        sock->setOnRead([&sem, total, received, bad](Buffer::Ptr &buf, struct sockaddr *, int) {
+            for (size_t i = 0; i < buf->size(); ++i) {
+                if (buf->data()[i] != expected(*received + i)) {
+                    ++*bad;
+                }
+            }
+            *received += buf->size();
+            if (*received == total) {
+                sem.post();
+            }
+        });
+        sock->setOnErr([](const SockException &err) { DebugL << "session closed: " << err; });
+        *session = sock;
+    });
+    if (!server->listen(0, "127.0.0.1")) {
+        ErrorL << "listen failed";
+        return -1;
+    }
+
+    auto client = Socket::createSocket(poller);
+    client->connect("127.0.0.1", server->get_local_port(), [&sem](const SockException &err) {
+        if (err) {
+            ErrorL << "connect failed: " << err;
+        }
+        sem.post();
+    });
+    sem.wait();
+
+    Ticker ticker;
+    client->send(kHeader);
+    client->sendFile(kFilePath, kRegionOffset, kRegionSize, [](const SockException &err, uint64_t sent) {
+        InfoL << "send file finished: " << err << ", sent: " << sent;
+    });
+    client->send(kTrailer);
+    sem.wait();
+    InfoL << "received " << *received << " bytes in " << ticker.elapsedTime() << "ms, bad bytes: " << *bad;
+
+    //接收端暂停接收，发送端写满内核缓存后关闭连接
+    poller->sync([&]() { (*session)->enableRecv(false); });
+    client->sendFile(kFilePath, 0, 0, [&sem](const SockException &err, uint64_t sent) {
+        InfoL << "send file finished: " << err << ", sent: " << sent << "/" << kFileSize;
+        sem.post();
+    });
+    this_thread::sleep_for(chrono::milliseconds(100));
+    InfoL << "socket busy: " << client->isSocketBusy() << ", unsent: " << client->getSendBufferSize();
+    client->closeSock();
+    sem.wait();
+
+    client = nullptr;
+    poller->sync([&]() { *session = nullptr; });
+    server = nullptr;
+    remove(kFilePath);
+    return 0;
+}
@@ -0,0 +1,97 @@
+//
+// Created by FFZero on 2025-05-17.
+//
+
+#include <set>
+#include <csignal>
+#include "Util/logger.h"
+#include "Thread/semaphore.h"
+#include "Network/Socket.h"
+
+using namespace std;
+using namespace FFZKit;
+
+//大量连接共享poller的读缓存；对端暂停接收时，发送端通过isSocketBusy/onFlush感知背压
+static const size_t kClientCount = 100;
+static const size_t kBlockSize = 64 * 1024;
+
+int main() {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+    Logger::Instance().setWriter(std::make_shared<AsyncLogWriter>());
+
+    auto poller = EventPollerPool::Instance().getPoller();
+    semaphore sem;
+
+    //echo服务器，记录读缓存地址
+    auto server = Socket::createSocket(poller);
+    auto read_buffers = std::make_shared<set<void *> >();
+    auto sessions = std::make_shared<vector<Socket::Ptr> >();
+    server->setOnAccept([read_buffers, sessions](Socket::Ptr &sock) {
+        weak_ptr<Socket> weak_sock = sock;
+        sock->setOnRead([weak_sock, read_buffers](Buffer::Ptr &buf, struct sockaddr *, int) {
+            read_buffers->emplace(buf->data());
+            if (auto strong_sock = weak_sock.lock()) {
+                strong_sock->send(buf->toString());
+            }
+        });
+        sock->setOnErr([](const SockException &err) { DebugL << "session closed: " << err; });
+        sessions->emplace_back(sock);
+    });
+    if (!server->listen(0, "127.0.0.1")) {
+        ErrorL << "listen failed";
+        return -1;
+    }
+    auto port = server->get_local_port();
+    InfoL << "listen on port: " << port;
+
+    vector<Socket::Ptr> clients;
+    auto echoed = std::make_shared<atomic<size_t> >(0);
+    for (size_t i = 0; i < kClientCount; ++i) {
+        auto client = Socket::createSocket(poller);
+        client->setOnRead([echoed, &sem](Buffer::Ptr &buf, struct sockaddr *, int) {
+            if (++*echoed == kClientCount) {
+                sem.post();
+            }
+        });
+        client->connect("127.0.0.1", port, [client](const SockException &err) {
+            if (err) {
+                ErrorL << "connect failed: " << err;
+                return;
+            }
+            client->send("hello");
+        });
+        clients.emplace_back(client);
+    }
+    sem.wait();
+    InfoL << "echoed " << echoed->load() << " connections, distinct read buffers on server: " << read_buffers->size();
+
+    //背压：客户端暂停接收，服务端持续发送直到内核缓存写满
+    auto client = clients.front();
+    client->enableRecv(false);
+    poller->sync([&]() {
+        auto session = sessions->front();
+        string block(kBlockSize, 'x');
+        size_t sent = 0;
+        while (!session->isSocketBusy()) {
+            session->send(block);
+            sent += block.size();
+        }
+        InfoL << "session busy after " << sent << " bytes, send buffer: " << session->getSendBufferSize()
+              << " bytes in " << session->getSendBufferCount() << " buffers";
+        session->setOnFlush([&sem, session]() {
+            InfoL << "session flushed, send buffer: " << session->getSendBufferSize();
+            sem.post();
+            return false;
+        });
+        //丢弃之后收到的数据
+        client->setOnRead([](Buffer::Ptr &buf, struct sockaddr *, int) {});
+    });
+    client->enableRecv(true);
+    sem.wait();
+
+    client = nullptr;
+    clients.clear();
+    poller->sync([&]() { sessions->clear(); });
+    server = nullptr;
+    return 0;
+}
@@ -0,0 +1,69 @@
+//
+// Created by FFZero on 2025-03-08.
+//
+
+#include <atomic>
+
+#include "Util/logger.h"
+#include "Util/TimeTicker.h"
+#include "Thread/Strand.h"
+#include "Thread/ThreadPool.h"
+
+using namespace std;
+using namespace FFZKit;
+
+#define STRAND_SIZE 10000
+#define TASK_PER_STRAND 10
+
+int main() {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+    Logger::Instance().setWriter(std::make_shared<AsyncLogWriter>());
+
+    auto pool = std::make_shared<ThreadPool>(4, ThreadPool::PRIORITY_HIGHEST, true, false);
+
+    //每个strand模拟一个actor，其状态不加锁访问
+    struct Actor {
+        Strand::Ptr strand;
+        int expected = 0;
+        int disorder = 0;
+        atomic<int> running { 0 };
+        int overlapped = 0;
+    };
+
+    vector<Actor> actors(STRAND_SIZE);
+    for (auto &actor : actors) {
+        actor.strand = Strand::create(pool);
+    }
+
+    semaphore sem;
+    atomic<int> remain(STRAND_SIZE * TASK_PER_STRAND);
+    Ticker ticker;
+
+    for (int i = 0; i < TASK_PER_STRAND; ++i) {
+        for (auto &actor : actors) {
+            auto ptr = &actor;
+            actor.strand->async([ptr, i, &remain, &sem]() {
+                if (ptr->running++) {
+                    ++ptr->overlapped;
+                }
+                if (ptr->expected++ != i) {
+                    ++ptr->disorder;
+                }
+                --ptr->running;
+                if (--remain == 0) {
+                    sem.post();
+                }
+            });
+        }
+    }
+
+    sem.wait();
+    int disorder = 0, overlapped = 0;
+    for (auto &actor : actors) {
+        disorder += actor.disorder;
+        overlapped += actor.overlapped;
+    }
+    InfoL << STRAND_SIZE * TASK_PER_STRAND << " tasks on " << STRAND_SIZE << " strands done, cost: "
+          << ticker.elapsedTime() << " ms, disorder: " << disorder << ", overlapped: " << overlapped;
+    return 0;
+}
@@ -0,0 +1,72 @@
+//
+// Created by FFZero on 2025-04-26.
+//
+
+#include "Util/logger.h"
+#include "Util/TimeTicker.h"
+#include "Thread/semaphore.h"
+#include "Poller/EventPoller.h"
+
+using namespace std;
+using namespace FFZKit;
+
+static uint64_t nowUs() {
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//向poller投递大量跨线程任务，同时用5ms定时器观察事件循环被阻塞的程度
+static void floodTasks(const EventPoller::Ptr &poller, size_t task_count) {
+    auto max_late = std::make_shared<uint64_t>(0);
+    auto last = std::make_shared<uint64_t>(nowUs());
+    auto timer = poller->doDelayTask(5, [max_late, last]() -> uint64_t {
+        auto now = nowUs();
+        auto late = now - *last;
+        *max_late = (std::max)(*max_late, late);
+        *last = now;
+        return 5;
+    });
+    this_thread::sleep_for(chrono::milliseconds(50));
+
+    //先阻塞poller线程，让所有任务一次性堆积在队列中
+    semaphore sem, sem_block;
+    poller->async([&sem_block, max_late, last]() {
+        sem_block.wait();
+        *max_late = 0;
+        *last = nowUs();
+    }, false);
+    Ticker ticker;
+    for (size_t i = 0; i < task_count; ++i) {
+        poller->async([i, task_count, &sem, max_late, last]() {
+            //模拟少量计算
+            volatile size_t sum = 0;
+            for (size_t n = 0; n < 1000; ++n) {
+                sum = sum + n;
+            }
+            if (i == task_count - 1) {
+                //计入最后一次定时器触发至今的间隔
+                *max_late = (std::max)(*max_late, nowUs() - *last);
+                sem.post();
+            }
+        }, false);
+    }
+    sem_block.post();
+    sem.wait();
+    timer->cancel();
+    InfoL << task_count << " tasks done, cost: " << ticker.elapsedTime() << "ms, max timer interval: " << *max_late / 1000 << "ms"
+          << ", budget hit: " << poller->getTaskBudgetHit();
+}
+
+int main() {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+    Logger::Instance().setWriter(std::make_shared<AsyncLogWriter>());
+
+    auto poller = EventPollerPool::Instance().getPoller(false);
+    InfoL << "without task budget:";
+    floodTasks(poller, 100000);
+
+    //每次循环最多执行1000个任务或者1ms
+    poller->setTaskBudget(1000, 1000);
+    InfoL << "with task budget:";
+    floodTasks(poller, 100000);
+    return 0;
+}
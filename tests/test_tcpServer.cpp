@@ -0,0 +1,102 @@
+//
+// Created by FFZero on 2025-06-28.
+//
+
+#include "Util/logger.h"
+#include "Util/TimeTicker.h"
+#include "Thread/semaphore.h"
+#include "Network/TcpServer.h"
+
+using namespace std;
+using namespace FFZKit;
+
+//tcp服务器：回显会话，多个客户端并发收发后统计；部分客户端保持空闲，由服务器巡检按空闲超时关闭
+static const size_t kClientCount = 16;
+static const size_t kIdleCount = 4;
+static const size_t kBytesPerClient = 1024 * 1024;
+
+class EchoSession : public Session {
+public:
+    EchoSession(const Socket::Ptr &sock) : Session(sock) {
+        DebugL << get_peer_ip() << ":" << get_peer_port();
+    }
+
+    void onRecv(const Buffer::Ptr &buf) override {
+        send(buf);
+    }
+
+    void onError(const SockException &err) override {
+        DebugL << get_peer_ip() << ":" << get_peer_port() << " " << err;
+    }
+};
+
+int main() {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+    Logger::Instance().setWriter(std::make_shared<AsyncLogWriter>());
+    Logger::Instance().setLevel(LInfo);
+
+    auto server = std::make_shared<TcpServer>();
+    server->setIdleTimeout(2);
+    if (!server->start<EchoSession>(0, "127.0.0.1")) {
+        ErrorL << "start tcp server failed";
+        return -1;
+    }
+
+    semaphore sem;
+    vector<Socket::Ptr> clients;
+    auto echoed = std::make_shared<atomic<size_t> >(0);
+    auto closed = std::make_shared<atomic<size_t> >(0);
+    for (size_t i = 0; i < kClientCount + kIdleCount; ++i) {
+        auto client = Socket::createSocket(EventPollerPool::Instance().getPoller(false));
+        client->setOnRead([&sem, echoed](Buffer::Ptr &buf, struct sockaddr *, int) {
+            if ((*echoed += buf->size()) == kClientCount * kBytesPerClient) {
+                sem.post();
+            }
+        });
+        client->setOnErr([&sem, closed](const SockException &err) {
+            DebugL << "client closed: " << err;
+            if (++*closed == kIdleCount) {
+                sem.post();
+            }
+        });
+        client->connect("127.0.0.1", server->getPort(), [&sem](const SockException &err) {
+            if (err) {
+                ErrorL << "connect failed: " << err;
+            }
+            sem.post();
+        });
+        clients.emplace_back(std::move(client));
+    }
+    for (size_t i = 0; i < clients.size(); ++i) {
+        sem.wait();
+    }
+
+    Ticker ticker;
+    string block(4096, 'a');
+    for (size_t i = 0; i < kClientCount; ++i) {
+        for (size_t sent = 0; sent < kBytesPerClient; sent += block.size()) {
+            clients[i]->send(block);
+        }
+    }
+    sem.wait();
+    auto stat = server->getStatistic();
+    InfoL << "echoed " << *echoed << " bytes in " << ticker.elapsedTime() << "ms, accepted: " << stat.accepted
+          << ", online: " << stat.online << ", recv bytes: " << stat.recv_bytes;
+
+    //保持发送的客户端定时发数据，空闲的客户端应被服务器关闭
+    for (int i = 0; i < 4; ++i) {
+        this_thread::sleep_for(chrono::milliseconds(1000));
+        for (size_t j = 0; j < kClientCount; ++j) {
+            clients[j]->send("ping");
+        }
+    }
+    sem.wait();
+    stat = server->getStatistic();
+    InfoL << "after idle timeout, online: " << stat.online << ", closed: " << stat.closed << ", timeout: " << stat.timeout;
+
+    server = nullptr;
+    this_thread::sleep_for(chrono::milliseconds(100));
+    InfoL << "after server destroyed, closed clients: " << *closed;
+    clients.clear();
+    return 0;
+}
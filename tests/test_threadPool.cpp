@@ -14,6 +14,8 @@ int main() {
 
     auto cpus = std::thread::hardware_concurrency();
     ThreadPool pool(cpus, ThreadPool::PRIORITY_HIGHEST, true);
+    //任务耗时追踪默认关闭
+    pool.enableTaskTrace();
 
     auto task_second = 3;
     auto task_count = cpus * 4;
@@ -28,6 +30,8 @@ int main() {
             sem.post();
         });
 
+        //作用域内投递的任务都会带上该标签，用于慢任务追踪
+        TaskLabel label("sleep task");
         for (int i = 0; i < task_count; ++i) {
             pool.async([i, task_second, &vec, token]() {
                 setThreadName(("thread_pool " + to_string(i)).c_str());
@@ -43,5 +47,24 @@ int main() {
     for (auto &i : vec) {
         InfoL << "task result: " << i;
     }
+    InfoL << "task trace: " << pool.getTaskTracer().dump();
+
+    //带截止时间的任务优先于先打入的普通任务执行，且截止时间越早越先执行
+    ThreadPool edf_pool(1, ThreadPool::PRIORITY_HIGHEST, false);
+    for (int i = 0; i < 3; ++i) {
+        edf_pool.async([i]() {
+            InfoL << "bulk task " << i << " done!";
+        });
+    }
+    edf_pool.async_budget([]() { InfoL << "deadline task (budget 20ms) done!"; }, 20);
+    edf_pool.async_budget([]() { InfoL << "deadline task (budget 10ms) done!"; }, 10);
+    //截止时间为0的任务同样计入统计(必然超时)
+    edf_pool.async_deadline([]() { InfoL << "deadline task (deadline 0) done!"; }, 0);
+    edf_pool.start();
+    edf_pool.sync([&]() {
+        uint64_t total, missed;
+        edf_pool.getDeadlineStatistic(total, missed);
+        InfoL << "deadline task total: " << total << ", missed: " << missed;
+    });
     return 0; 
 }
\ No newline at end of file
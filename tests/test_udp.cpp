@@ -0,0 +1,71 @@
+//
+// Created by FFZero on 2025-05-31.
+//
+
+#include "Util/logger.h"
+#include "Util/TimeTicker.h"
+#include "Thread/semaphore.h"
+#include "Network/Socket.h"
+
+using namespace std;
+using namespace FFZKit;
+
+//一个udp socket向多个接收端批量发送数据报：发送端关闭try_flush后一次sendmmsg发送多个目标，接收端使用recvmmsg批量读取
+static const size_t kReceiverCount = 3;
+static const size_t kPacketCount = 30000;
+static const size_t kPacketSize = 200;
+static const size_t kBatch = 64;
+
+int main() {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+    Logger::Instance().setWriter(std::make_shared<AsyncLogWriter>());
+
+    auto poller = EventPollerPool::Instance().getPoller();
+    auto sender = Socket::createSocket(poller);
+    sender->bindUdpSock(0, "127.0.0.1");
+    auto sender_port = sender->get_local_port();
+
+    //各接收端收到的数据报个数，只在poller线程访问
+    auto received = std::make_shared<vector<size_t> >(kReceiverCount);
+    vector<Socket::Ptr> receivers;
+    vector<struct sockaddr_storage> addrs;
+    for (size_t i = 0; i < kReceiverCount; ++i) {
+        auto receiver = Socket::createSocket(poller);
+        if (!receiver->bindUdpSock(0, "127.0.0.1")) {
+            ErrorL << "bind udp socket failed";
+            return -1;
+        }
+        receiver->setOnRead([received, i, sender_port](Buffer::Ptr &buf, struct sockaddr *addr, int addr_len) {
+            if (SockUtil::inet_port(addr) != sender_port || buf->size() != kPacketSize) {
+                WarnL << "unexpected datagram from port " << SockUtil::inet_port(addr) << ", size: " << buf->size();
+                return;
+            }
+            ++(*received)[i];
+        });
+        addrs.emplace_back(SockUtil::make_sockaddr("127.0.0.1", receiver->get_local_port()));
+        receivers.emplace_back(receiver);
+    }
+
+    Ticker ticker;
+    for (size_t i = 0; i < kPacketCount;) {
+        for (size_t j = 0; j < kBatch && i < kPacketCount; ++j, ++i) {
+            auto buf = BufferRaw::create(kPacketSize);
+            buf->setSize(kPacketSize);
+            auto &addr = addrs[i % kReceiverCount];
+            sender->send(std::move(buf), (struct sockaddr *)&addr, 0, false);
+        }
+        //一次系统调用发送kBatch个数据报
+        sender->flushAll();
+        //给接收端留出读取时间，避免回环网卡丢包
+        poller->sync([]() {});
+    }
+    InfoL << "sent " << kPacketCount << " datagrams in " << ticker.elapsedTime() << "ms";
+
+    this_thread::sleep_for(chrono::milliseconds(200));
+    poller->sync([&]() {
+        for (size_t i = 0; i < kReceiverCount; ++i) {
+            InfoL << "receiver " << i << " received " << (*received)[i] << " datagrams";
+        }
+    });
+    return 0;
+}
@@ -0,0 +1,93 @@
+//
+// Created by FFZero on 2025-06-07.
+//
+
+#include "Util/logger.h"
+#include "Util/TimeTicker.h"
+#include "Network/Socket.h"
+
+using namespace std;
+using namespace FFZKit;
+
+//udp分段卸载：发送端开启GSO，一个大Buffer一次系统调用发出多个同尺寸数据报；
+//一个接收端开启GRO，合并读取后拆分为Buffer视图，另一个接收端正常逐个读取，两者收到的数据报应一致
+static const uint16_t kSegmentSize = 1200;
+static const size_t kSegmentsPerBuffer = 100;
+static const size_t kBufferCount = 200;
+
+struct RecvStat {
+    size_t count = 0;
+    size_t bad = 0;
+    uint32_t next_seq = 0;
+};
+
+static void onDatagram(RecvStat &stat, const Buffer::Ptr &buf) {
+    uint32_t seq;
+    if (buf->size() != kSegmentSize) {
+        ++stat.bad;
+        return;
+    }
+    memcpy(&seq, buf->data(), sizeof(seq));
+    if (seq != stat.next_seq) {
+        //回环网卡也可能因接收缓存满而丢包，此时只记录序号跳变
+        WarnL << "seq jump: " << stat.next_seq << " -> " << seq;
+    }
+    stat.next_seq = seq + 1;
+    ++stat.count;
+}
+
+int main() {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+    Logger::Instance().setWriter(std::make_shared<AsyncLogWriter>());
+
+    auto poller = EventPollerPool::Instance().getPoller();
+    auto sender = Socket::createSocket(poller);
+    sender->bindUdpSock(0, "127.0.0.1");
+    if (!sender->enableUdpGso(kSegmentSize)) {
+        WarnL << "udp gso not supported, large buffers are sent as single datagrams";
+    }
+
+    auto stats = std::make_shared<vector<RecvStat> >(2);
+    vector<Socket::Ptr> receivers;
+    vector<struct sockaddr_storage> addrs;
+    for (size_t i = 0; i < 2; ++i) {
+        auto receiver = Socket::createSocket(poller);
+        receiver->bindUdpSock(0, "127.0.0.1");
+        SockUtil::setRecvBuf(receiver->rawFD(), 8 * 1024 * 1024);
+        if (i == 0 && !receiver->enableUdpGro()) {
+            WarnL << "udp gro not supported";
+        }
+        receiver->setOnRead([stats, i](Buffer::Ptr &buf, struct sockaddr *, int) {
+            onDatagram((*stats)[i], buf);
+        });
+        addrs.emplace_back(SockUtil::make_sockaddr("127.0.0.1", receiver->get_local_port()));
+        receivers.emplace_back(receiver);
+    }
+
+    Ticker ticker;
+    uint32_t seq = 0;
+    for (size_t i = 0; i < kBufferCount; ++i) {
+        auto buf = BufferRaw::create(kSegmentSize * kSegmentsPerBuffer);
+        buf->setSize(kSegmentSize * kSegmentsPerBuffer);
+        memset(buf->data(), 'x', buf->size());
+        for (size_t j = 0; j < kSegmentsPerBuffer; ++j, ++seq) {
+            memcpy(buf->data() + j * kSegmentSize, &seq, sizeof(seq));
+        }
+        //同一个Buffer发给两个接收端，发送缓存中的视图共享同一份数据
+        for (auto &addr : addrs) {
+            sender->send(buf, (struct sockaddr *)&addr, 0);
+        }
+        //给接收端留出读取时间，避免回环网卡丢包
+        poller->sync([]() {});
+    }
+    InfoL << "sent " << seq << " datagrams to each receiver in " << ticker.elapsedTime() << "ms";
+
+    this_thread::sleep_for(chrono::milliseconds(200));
+    poller->sync([&]() {
+        for (size_t i = 0; i < 2; ++i) {
+            auto &stat = (*stats)[i];
+            InfoL << (i == 0 ? "gro" : "normal") << " receiver got " << stat.count << " datagrams, bad size: " << stat.bad;
+        }
+    });
+    return 0;
+}
@@ -0,0 +1,41 @@
+//
+// Created by FFZero on 2025-04-19.
+//
+
+#include "Util/logger.h"
+#include "Thread/TaskTracer.h"
+#include "Poller/PollerWatchdog.h"
+
+using namespace std;
+using namespace FFZKit;
+
+int main() {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+    Logger::Instance().setWriter(std::make_shared<AsyncLogWriter>());
+
+    // 执行超过200ms的回调或任务视为卡顿，并打印卡住线程的调用栈
+    PollerWatchdog watchdog(200, true);
+    watchdog.watchPool();
+    watchdog.setOnStall([&watchdog](const PollerWatchdog::Stall &stall) {
+        WarnL << "first stall: " << stall.poller << ", running: " << stall.label << ", elapsed: " << stall.elapsed_ms << "ms";
+        // 回调在锁外执行，可以在其中修改回调；之后的卡顿使用默认的警告日志
+        watchdog.setOnStall(nullptr);
+    });
+
+    auto poller = EventPollerPool::Instance().getPoller(false);
+    {
+        TaskLabel label("blocking task");
+        poller->async([]() {
+            // 模拟在poller线程中执行了阻塞调用
+            this_thread::sleep_for(chrono::milliseconds(500));
+        });
+    }
+    poller->doDelayTask(600, []() {
+        this_thread::sleep_for(chrono::milliseconds(300));
+        return 0;
+    });
+
+    this_thread::sleep_for(chrono::seconds(2));
+    InfoL << "stall count: " << watchdog.stallCount();
+    return 0;
+}
@@ -0,0 +1,130 @@
+//
+// Created by FFZero on 2025-06-14.
+//
+
+#include "Util/logger.h"
+#include "Util/TimeTicker.h"
+#include "Thread/semaphore.h"
+#include "Network/Socket.h"
+
+using namespace std;
+using namespace FFZKit;
+
+//tcp零拷贝发送：发送的Buffer在收到完成通知前保持持有，之后释放回缓存池；接收端校验数据完整性
+//发送端在数据未被确认时关闭，Buffer仍保持持有直到完成通知到达
+static const size_t kBlockSize = 1024 * 1024;
+static const size_t kBlockCount = 64;
+
+//统计存活个数的Buffer
+class CountedBuffer : public Buffer {
+public:
+    CountedBuffer(size_t size) : _data(size, 'z') {
+        ++s_alive;
+    }
+
+    ~CountedBuffer() override {
+        --s_alive;
+    }
+
+    char *data() const override {
+        return (char *)_data.data();
+    }
+
+    size_t size() const override {
+        return _data.size();
+    }
+
+    static std::atomic<size_t> s_alive;
+
+private:
+    std::string _data;
+};
+
+std::atomic<size_t> CountedBuffer::s_alive { 0 };
+
+int main() {
+    Logger::Instance().add(std::make_shared<ConsoleChannel>());
+    Logger::Instance().setWriter(std::make_shared<AsyncLogWriter>());
+
+    auto poller = EventPollerPool::Instance().getPoller();
+    semaphore sem;
+
+    //接收端按字节序号校验数据
+    auto server = Socket::createSocket(poller);
+    auto received = std::make_shared<size_t>(0);
+    auto bad = std::make_shared<size_t>(0);
+    auto session = std::make_shared<Socket::Ptr>();
+    server->setOnAccept([&sem, received, bad, session](Socket::Ptr &sock) {
+        sock->setOnRead([&sem, received, bad](Buffer::Ptr &buf, struct sockaddr *, int) {
+            auto data = buf->data();
+            for (size_t i = 0; i < buf->size(); ++i) {
+                if (data[i] != (char)((*received + i) % 251)) {
+                    ++*bad;
+                }
+            }
+            *received += buf->size();
+            if (*received == kBlockSize * kBlockCount) {
+                sem.post();
+            }
+        });
+        sock->setOnErr([](const SockException &err) { DebugL << "session closed: " << err; });
+        *session = sock;
+    });
+    if (!server->listen(0, "127.0.0.1")) {
+        ErrorL << "listen failed";
+        return -1;
+    }
+
+    auto client = Socket::createSocket(poller);
+    client->connect("127.0.0.1", server->get_local_port(), [&sem](const SockException &err) {
+        if (err) {
+            ErrorL << "connect failed: " << err;
+        }
+        sem.post();
+    });
+    sem.wait();
+    if (!client->enableZeroCopy()) {
+        WarnL << "MSG_ZEROCOPY not supported, fall back to copy";
+    }
+
+    Ticker ticker;
+    size_t offset = 0;
+    for (size_t i = 0; i < kBlockCount; ++i) {
+        auto buf = BufferRaw::create(kBlockSize);
+        buf->setSize(kBlockSize);
+        for (size_t j = 0; j < kBlockSize; ++j, ++offset) {
+            buf->data()[j] = (char)(offset % 251);
+        }
+        client->send(std::move(buf));
+    }
+    InfoL << "pending zerocopy buffers after send: " << client->getZeroCopyPendingCount()
+          << ", unsent: " << client->getSendBufferSize();
+    sem.wait();
+    InfoL << "received " << *received << " bytes in " << ticker.elapsedTime() << "ms, bad bytes: " << *bad;
+
+    //完成通知在可写/错误事件中处理，等待全部确认
+    for (int i = 0; i < 100 && client->getZeroCopyPendingCount(); ++i) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    InfoL << "pending zerocopy buffers after completion: " << client->getZeroCopyPendingCount();
+
+    //接收端暂停接收，发送端关闭时内核中仍有未确认的数据
+    poller->sync([&]() { (*session)->enableRecv(false); });
+    for (size_t i = 0; i < kBlockCount; ++i) {
+        client->send(std::make_shared<CountedBuffer>(kBlockSize));
+    }
+    this_thread::sleep_for(chrono::milliseconds(100));
+    InfoL << "pending zerocopy buffers before close: " << client->getZeroCopyPendingCount();
+    client = nullptr;
+    this_thread::sleep_for(chrono::milliseconds(100));
+    InfoL << "buffers alive after close: " << CountedBuffer::s_alive;
+    poller->sync([&]() { (*session)->enableRecv(true); });
+    for (int i = 0; i < 100 && CountedBuffer::s_alive; ++i) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    InfoL << "buffers alive after peer received: " << CountedBuffer::s_alive;
+
+    poller->sync([&]() { *session = nullptr; });
+    server = nullptr;
+    return 0;
+}